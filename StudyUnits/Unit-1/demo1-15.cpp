@@ -0,0 +1,345 @@
+// Indexed part-number lookup to replace the linear scan of demo1-7 / demo1-8.
+// A PartCatalog is bulk-built once over Part records and is read-only
+// afterwards. Two index modes are offered:
+//   SORTED       - flat sorted key/price columns + branchless binary search
+//   PERFECT_HASH - hash-and-displace perfect hash, one probe per lookup
+// A PERFECT_HASH build that cannot place every key falls back to SORTED.
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+using namespace std;
+
+struct Part {
+    int partNum;
+    double partPrice;
+};
+
+class PartCatalog {
+public:
+    enum Mode { SORTED, PERFECT_HASH };
+
+    // Builds the index. When a part number appears more than once the
+    // last record wins, as in demo1-8's scan, which keeps the last match.
+    PartCatalog(const Part* parts, size_t count, Mode m = SORTED);
+
+    // the mode actually built: SORTED if a PERFECT_HASH build fell back
+    Mode getMode() const { return mode; }
+    size_t size() const { return numParts; }
+
+    // Single lookup: returns true and sets price when the part exists
+    bool findPrice(int neededPart, double& price) const;
+
+    // Batched lookup: found[i] is 1 when prices[i] holds a valid price.
+    // Returns the number of parts found.
+    size_t findPrices(const int* needed, size_t count,
+                      double* prices, unsigned char* found) const;
+
+private:
+    Mode mode;
+    size_t numParts{};
+
+    // SORTED mode: two parallel columns, keys searched without branches
+    vector<int> keys;
+    vector<double> values;
+
+    // PERFECT_HASH mode: one displacement seed per bucket, one slot per key
+    vector<uint32_t> seeds;
+    vector<Part> slots;
+    static const uint32_t MAX_SEEDS = 1 << 16;   // tries per bucket before giving up
+
+    void buildSorted(vector<Part>& unique);
+    bool buildPerfectHash(const vector<Part>& unique);
+
+    size_t lowerBound(int key) const;
+    size_t slotFor(int key) const {
+        uint32_t b = fastRange(mix(key, 0), seeds.size());
+        return fastRange(mix(key, seeds[b]), slots.size());
+    }
+
+    static uint32_t mix(int key, uint32_t seed) {
+        uint64_t x = static_cast<uint32_t>(key) ^ (uint64_t(seed) << 32 | seed);
+        x ^= x >> 33; x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33; x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return static_cast<uint32_t>(x);
+    }
+    // maps a 32-bit hash onto [0, n) without a division
+    static uint32_t fastRange(uint32_t h, size_t n) {
+        return static_cast<uint32_t>((uint64_t(h) * n) >> 32);
+    }
+};
+
+PartCatalog::PartCatalog(const Part* parts, size_t count, Mode m) : mode(m) {
+    // stable sort keeps duplicates in input order, so the last of each run
+    // is the last record
+    vector<Part> unique(parts, parts + count);
+    stable_sort(unique.begin(), unique.end(),
+                [](const Part& a, const Part& b) { return a.partNum < b.partNum; });
+    size_t kept = 0;
+    for (const Part& p : unique) {
+        if (kept > 0 && unique[kept - 1].partNum == p.partNum)
+            unique[kept - 1] = p;
+        else
+            unique[kept++] = p;
+    }
+    unique.resize(kept);
+    numParts = unique.size();
+
+    if (mode == PERFECT_HASH && !buildPerfectHash(unique)) {
+        seeds.clear();
+        slots.clear();
+        mode = SORTED;
+    }
+    if (mode == SORTED)
+        buildSorted(unique);
+}
+
+void PartCatalog::buildSorted(vector<Part>& unique) {
+    keys.resize(unique.size());
+    values.resize(unique.size());
+    for (size_t x = 0; x < unique.size(); ++x) {
+        keys[x] = unique[x].partNum;
+        values[x] = unique[x].partPrice;
+    }
+}
+
+// Returns false if some bucket found no free slots within MAX_SEEDS seeds
+bool PartCatalog::buildPerfectHash(const vector<Part>& unique) {
+    const size_t n = unique.size();
+    if (n == 0) return true;
+
+    // about 4 keys per bucket, table 85% full
+    seeds.assign(n / 4 + 1, 0);
+    slots.resize(n + n * 15 / 100 + 1);
+
+    vector<vector<int>> buckets(seeds.size());
+    for (size_t x = 0; x < n; ++x)
+        buckets[fastRange(mix(unique[x].partNum, 0), seeds.size())].push_back(int(x));
+
+    // place the largest buckets first while the table is still empty
+    vector<uint32_t> order(buckets.size());
+    iota(order.begin(), order.end(), 0);
+    sort(order.begin(), order.end(),
+         [&](uint32_t a, uint32_t b) { return buckets[a].size() > buckets[b].size(); });
+
+    vector<unsigned char> taken(slots.size(), 0);
+    vector<size_t> trial;
+    for (uint32_t b : order) {
+        const vector<int>& bucket = buckets[b];
+        if (bucket.empty()) break;
+        bool placed = false;
+        for (uint32_t seed = 1; seed <= MAX_SEEDS && !placed; ++seed) {
+            trial.clear();
+            bool ok = true;
+            for (int idx : bucket) {
+                size_t s = fastRange(mix(unique[idx].partNum, seed), slots.size());
+                if (taken[s] || find(trial.begin(), trial.end(), s) != trial.end()) {
+                    ok = false;
+                    break;
+                }
+                trial.push_back(s);
+            }
+            if (!ok) continue;
+            seeds[b] = seed;
+            for (size_t k = 0; k < bucket.size(); ++k) {
+                taken[trial[k]] = 1;
+                slots[trial[k]] = unique[bucket[k]];
+            }
+            placed = true;
+        }
+        if (!placed) return false;
+    }
+
+    // An empty slot holds a real key that hashes somewhere else, so a probe
+    // that lands there can never match and no "occupied" flag is needed.
+    for (size_t s = 0; s < slots.size(); ++s)
+        if (!taken[s]) slots[s] = unique[0];
+    return true;
+}
+
+size_t PartCatalog::lowerBound(int key) const {
+    if (keys.empty()) return 0;
+    const int* base = keys.data();
+    size_t len = keys.size();
+    while (len > 1) {
+        size_t half = len / 2;
+        base = (base[half] < key) ? base + half : base;  // compiles to cmov
+        len -= half;
+    }
+    return size_t(base - keys.data()) + (*base < key);
+}
+
+bool PartCatalog::findPrice(int neededPart, double& price) const {
+    if (mode == SORTED) {
+        size_t x = lowerBound(neededPart);
+        if (x < keys.size() && keys[x] == neededPart) {
+            price = values[x];
+            return true;
+        }
+        return false;
+    }
+    if (slots.empty()) return false;
+    const Part& p = slots[slotFor(neededPart)];
+    if (p.partNum != neededPart) return false;
+    price = p.partPrice;
+    return true;
+}
+
+size_t PartCatalog::findPrices(const int* needed, size_t count,
+                               double* prices, unsigned char* found) const {
+    const size_t GROUP = 16;  // independent lookups kept in flight together
+    size_t hits = 0;
+
+    for (size_t start = 0; start < count; start += GROUP) {
+        size_t g = min(GROUP, count - start);
+        const int* q = needed + start;
+
+        if (mode == SORTED && !keys.empty()) {
+            // Run the searches in lockstep: each round issues g independent
+            // loads, so cache misses overlap instead of serialising.
+            const int* base[GROUP];
+            for (size_t j = 0; j < g; ++j) base[j] = keys.data();
+            size_t len = keys.size();
+            while (len > 1) {
+                size_t half = len / 2;
+                for (size_t j = 0; j < g; ++j)
+                    base[j] = (base[j][half] < q[j]) ? base[j] + half : base[j];
+                len -= half;
+            }
+            for (size_t j = 0; j < g; ++j) {
+                size_t x = size_t(base[j] - keys.data()) + (*base[j] < q[j]);
+                bool ok = x < keys.size() && keys[x] == q[j];
+                found[start + j] = ok;
+                prices[start + j] = ok ? values[x] : 0.0;
+                hits += ok;
+            }
+        } else if (mode == PERFECT_HASH && !slots.empty()) {
+            // hash the whole group and prefetch before touching any slot
+            size_t s[GROUP];
+            for (size_t j = 0; j < g; ++j) {
+                s[j] = slotFor(q[j]);
+                __builtin_prefetch(&slots[s[j]]);
+            }
+            for (size_t j = 0; j < g; ++j) {
+                const Part& p = slots[s[j]];
+                bool ok = p.partNum == q[j];
+                found[start + j] = ok;
+                prices[start + j] = ok ? p.partPrice : 0.0;
+                hits += ok;
+            }
+        } else {
+            for (size_t j = 0; j < g; ++j) {
+                found[start + j] = 0;
+                prices[start + j] = 0.0;
+            }
+        }
+    }
+    return hits;
+}
+
+// ---------------------------------------------------------------
+// Benchmark: the demo1-8 scan (no early exit) vs. both index modes
+// ---------------------------------------------------------------
+double scanPrice(const Part* part, size_t numParts, int neededPart, int& isFound) {
+    double price = 0.0;
+    isFound = 0;
+    for (size_t x = 0; x < numParts; ++x) {
+        if (neededPart == part[x].partNum) {
+            price = part[x].partPrice;
+            isFound = 1;
+        }
+    }
+    return price;
+}
+
+double nsPerLookup(chrono::steady_clock::time_point start, size_t lookups) {
+    chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+    return elapsed.count() / double(lookups);
+}
+
+void benchmark(size_t numParts, mt19937& rng) {
+    vector<Part> part(numParts);
+    for (size_t x = 0; x < numParts; ++x)
+        part[x] = { int(210 + x * 3), 1.0 + double(x % 1000) / 100.0 };
+    shuffle(part.begin(), part.end(), rng);
+
+    // 90% hits, 10% misses (part numbers that are not multiples of 3 apart)
+    const size_t NUM_QUERIES = 1 << 20;
+    vector<int> needed(NUM_QUERIES);
+    uniform_int_distribution<size_t> pick(0, numParts - 1);
+    for (size_t x = 0; x < NUM_QUERIES; ++x)
+        needed[x] = part[pick(rng)].partNum + (x % 10 == 0 ? 1 : 0);
+
+    double checksum = 0.0;
+
+    // the scan costs O(numParts) per query, so only run enough of them
+    size_t scanQueries = min(NUM_QUERIES, max<size_t>(16, 50000000 / numParts));
+    auto t = chrono::steady_clock::now();
+    for (size_t x = 0; x < scanQueries; ++x) {
+        int isFound;
+        checksum += scanPrice(part.data(), numParts, needed[x], isFound);
+    }
+    double scanNs = nsPerLookup(t, scanQueries);
+
+    vector<double> prices(NUM_QUERIES);
+    vector<unsigned char> found(NUM_QUERIES);
+    cout << setw(10) << numParts << "  scan " << setw(12) << scanNs << " ns";
+
+    for (PartCatalog::Mode mode : { PartCatalog::SORTED, PartCatalog::PERFECT_HASH }) {
+        t = chrono::steady_clock::now();
+        PartCatalog catalog(part.data(), numParts, mode);
+        chrono::duration<double, milli> buildMs = chrono::steady_clock::now() - t;
+
+        t = chrono::steady_clock::now();
+        for (size_t x = 0; x < NUM_QUERIES; ++x) {
+            double price;
+            if (catalog.findPrice(needed[x], price)) checksum += price;
+        }
+        double singleNs = nsPerLookup(t, NUM_QUERIES);
+
+        t = chrono::steady_clock::now();
+        catalog.findPrices(needed.data(), NUM_QUERIES, prices.data(), found.data());
+        double batchNs = nsPerLookup(t, NUM_QUERIES);
+        checksum += prices[NUM_QUERIES / 2];
+
+        cout << (mode == PartCatalog::SORTED ? " | sorted " : " | hash ")
+             << setw(6) << singleNs << " / " << setw(6) << batchNs << " ns"
+             << " (build " << buildMs.count() << " ms)";
+    }
+    cout << "   [" << checksum << "]" << endl;
+}
+
+int main() {
+    // the demo1-8 table, answered through both indexes
+    const int NUMPARTS = 4;
+    Part part[NUMPARTS] = { {210, 1.29}, {312, 2.45},
+                            {367, 5.99}, {456, 1.42} };
+    PartCatalog sorted(part, NUMPARTS);
+    PartCatalog hashed(part, NUMPARTS, PartCatalog::PERFECT_HASH);
+
+    int neededParts[] = { 312, 456, 999 };
+    for (int neededPart : neededParts) {
+        double a, b;
+        bool inSorted = sorted.findPrice(neededPart, a);
+        bool inHashed = hashed.findPrice(neededPart, b);
+        if (inSorted && inHashed && a == b)
+            cout << "Part " << neededPart << ": the price is " << a << endl;
+        else if (!inSorted && !inHashed)
+            cout << "Part " << neededPart << ": sorry -- no such part number." << endl;
+        else
+            cout << "Part " << neededPart << ": indexes disagree!" << endl;
+    }
+
+    cout << endl << fixed << setprecision(1)
+         << "     parts         scan/query   | mode single / batched per lookup" << endl;
+    mt19937 rng(2024);
+    for (size_t numParts : { size_t(4), size_t(10000), size_t(10000000) })
+        benchmark(numParts, rng);
+    return 0;
+}
@@ -0,0 +1,200 @@
+// Struct-of-arrays version of the demo1-8 parts table. Part numbers and
+// prices live in separate contiguous columns, so a scan for a part only
+// streams the partNum column (4 bytes per part instead of 16 for Part).
+// The key match runs 8 part numbers per AVX2 compare, 4 per SSE2 compare,
+// or one at a time; the kernel is picked once at runtime from the CPU's
+// features. Every match is returned, including duplicate part numbers.
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_KERNELS 1
+#endif
+using namespace std;
+
+struct Part {
+    int partNum;
+    double partPrice;
+};
+
+// ---------------------------------------------------------------
+// Match kernels: append the row of every partNum == needed to rows
+// ---------------------------------------------------------------
+typedef void (*MatchKernel)(const int*, size_t, int, vector<uint32_t>&);
+
+void matchScalar(const int* keys, size_t n, int needed, vector<uint32_t>& rows) {
+    for (size_t x = 0; x < n; ++x)
+        if (keys[x] == needed)
+            rows.push_back(uint32_t(x));
+}
+
+#ifdef HAVE_X86_KERNELS
+void matchSse2(const int* keys, size_t n, int needed, vector<uint32_t>& rows) {
+    const __m128i want = _mm_set1_epi32(needed);
+    size_t x = 0;
+    for (; x + 4 <= n; x += 4) {
+        __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + x));
+        unsigned mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(k, want)));
+        while (mask) {                 // almost always zero: one branch per 4 keys
+            rows.push_back(uint32_t(x + __builtin_ctz(mask)));
+            mask &= mask - 1;
+        }
+    }
+    size_t tail = rows.size();
+    matchScalar(keys + x, n - x, needed, rows);
+    for (size_t r = tail; r < rows.size(); ++r)  // tail rows are relative to x
+        rows[r] += uint32_t(x);
+}
+
+__attribute__((target("avx2")))
+void matchAvx2(const int* keys, size_t n, int needed, vector<uint32_t>& rows) {
+    const __m256i want = _mm256_set1_epi32(needed);
+    size_t x = 0;
+    // two compares per iteration keep both load ports busy
+    for (; x + 16 <= n; x += 16) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + x));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + x + 8));
+        unsigned lo = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, want)));
+        unsigned hi = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(b, want)));
+        unsigned mask = lo | (hi << 8);
+        while (mask) {
+            rows.push_back(uint32_t(x + __builtin_ctz(mask)));
+            mask &= mask - 1;
+        }
+    }
+    size_t tail = rows.size();
+    matchScalar(keys + x, n - x, needed, rows);
+    for (size_t r = tail; r < rows.size(); ++r)
+        rows[r] += uint32_t(x);
+}
+#endif
+
+const char* kernelName(MatchKernel k) {
+#ifdef HAVE_X86_KERNELS
+    if (k == matchAvx2) return "avx2";
+    if (k == matchSse2) return "sse2";
+#endif
+    return "scalar";
+}
+
+MatchKernel detectKernel() {
+#ifdef HAVE_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return matchAvx2;
+    if (__builtin_cpu_supports("sse2")) return matchSse2;
+#endif
+    return matchScalar;
+}
+
+// ---------------------------------------------------------------
+// PartCatalog: columnar storage + the best kernel for this machine
+// ---------------------------------------------------------------
+class PartCatalog {
+private:
+    vector<int> partNum;       // scanned column
+    vector<double> partPrice;  // only touched for matching rows
+    MatchKernel kernel;
+public:
+    PartCatalog() : kernel(detectKernel()) {}
+    PartCatalog(const Part* parts, size_t count) : PartCatalog() {
+        partNum.reserve(count);
+        partPrice.reserve(count);
+        for (size_t x = 0; x < count; ++x)
+            addPart(parts[x].partNum, parts[x].partPrice);
+    }
+
+    void addPart(int num, double price) {
+        partNum.push_back(num);
+        partPrice.push_back(price);
+    }
+    size_t size() const { return partNum.size(); }
+    double getPrice(uint32_t row) const { return partPrice[row]; }
+    int getPartNum(uint32_t row) const { return partNum[row]; }
+
+    // override the detected kernel (used by the benchmark)
+    void setKernel(MatchKernel k) { kernel = k; }
+    MatchKernel getKernel() const { return kernel; }
+
+    // Clears rows and fills it with every row whose part number matches.
+    // Returns the number of matches (0 means "no such part number").
+    size_t findAll(int neededPart, vector<uint32_t>& rows) const {
+        rows.clear();
+        kernel(partNum.data(), partNum.size(), neededPart, rows);
+        return rows.size();
+    }
+};
+
+// the demo1-8 loop over an array of structs, kept as the baseline
+size_t scanStructs(const Part* part, size_t numParts, int neededPart, double& lastPrice) {
+    size_t isFound = 0;
+    for (size_t x = 0; x < numParts; ++x) {
+        if (neededPart == part[x].partNum) {
+            lastPrice = part[x].partPrice;
+            ++isFound;
+        }
+    }
+    return isFound;
+}
+
+int main() {
+    // demo1-8's table with a duplicate entry for part 312
+    const int NUMPARTS = 5;
+    Part part[NUMPARTS] = { {210, 1.29}, {312, 2.45},
+                            {367, 5.99}, {456, 1.42}, {312, 2.15} };
+    PartCatalog catalog(part, NUMPARTS);
+    cout << "Using the " << kernelName(catalog.getKernel()) << " kernel" << endl;
+
+    vector<uint32_t> rows;
+    int neededParts[] = { 312, 456, 999 };
+    for (int neededPart : neededParts) {
+        if (catalog.findAll(neededPart, rows) == 0)
+            cout << "Part " << neededPart << ": sorry -- no such part number." << endl;
+        for (uint32_t row : rows)
+            cout << "Part " << neededPart << ": the price is "
+                 << catalog.getPrice(row) << endl;
+    }
+
+    // ---- benchmark: 10^7 parts, 1 in 1000 part numbers duplicated ----
+    const size_t BIG = 10000000;
+    const int QUERIES = 50;
+    mt19937 rng(7);
+    uniform_int_distribution<int> num(0, int(BIG) - 1);
+    vector<Part> big(BIG);
+    for (size_t x = 0; x < BIG; ++x)
+        big[x] = { x % 1000 == 0 ? num(rng) : int(x), 0.01 * double(x % 10000) };
+    PartCatalog bigCatalog(big.data(), BIG);
+
+    vector<int> needed(QUERIES);
+    for (int& n : needed) n = num(rng);
+
+    cout << endl << fixed << setprecision(2);
+    size_t expected = 0;
+    double lastPrice = 0.0;
+    auto t = chrono::steady_clock::now();
+    for (int q : needed) expected += scanStructs(big.data(), BIG, q, lastPrice);
+    chrono::duration<double, milli> ms = chrono::steady_clock::now() - t;
+    cout << "array of structs scan: " << ms.count() / QUERIES << " ms/query, "
+         << expected << " matches" << endl;
+
+    vector<MatchKernel> kernels = { matchScalar };
+#ifdef HAVE_X86_KERNELS
+    kernels.push_back(matchSse2);
+    if (__builtin_cpu_supports("avx2")) kernels.push_back(matchAvx2);
+#endif
+    for (MatchKernel k : kernels) {
+        bigCatalog.setKernel(k);
+        size_t matches = 0;
+        t = chrono::steady_clock::now();
+        for (int q : needed) matches += bigCatalog.findAll(q, rows);
+        ms = chrono::steady_clock::now() - t;
+        cout << "columnar " << setw(6) << kernelName(k) << " scan: "
+             << ms.count() / QUERIES << " ms/query, " << matches << " matches"
+             << (matches == expected ? "" : "  MISMATCH") << endl;
+    }
+    return 0;
+}
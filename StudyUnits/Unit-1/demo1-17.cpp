@@ -0,0 +1,229 @@
+// Bulk version of demo1-9. A RentMatrix is loaded from a text file of any
+// size ("rows cols" followed by rows*cols rents) and answers whole batches
+// of (floor, bedrooms) queries into a caller-provided output buffer.
+// Every query is bounds-checked; an out-of-range query yields NO_RENT.
+// Rents are never negative (load() rejects them), so NO_RENT is never a
+// real rent.
+// With AVX2 the check and the lookup run 8 queries at a time using a
+// masked gather, so invalid lanes are never loaded.
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <climits>
+#include <stdexcept>
+#include <cstddef>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_KERNELS 1
+#endif
+using namespace std;
+
+class RentMatrix {
+public:
+    static const int NO_RENT = -1;
+
+    RentMatrix() = default;
+    // An r x c table of zero rents; the sizes follow the same rules as load()
+    RentMatrix(int r, int c) : rows(checkSize(r, c) ? r : 0), cols(c), rents(size_t(rows) * cols, 0) {}
+
+    // Returns false (and leaves the matrix unchanged) on a malformed file,
+    // including one with a negative rent
+    bool load(istream& in);
+    bool loadFile(const string& path) {
+        ifstream in(path);
+        return in && load(in);
+    }
+
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+    // rents stored through at() must not be negative either
+    int& at(int floor, int bedrooms) {
+        if (unsigned(floor) >= unsigned(rows) || unsigned(bedrooms) >= unsigned(cols))
+            throw out_of_range("RentMatrix::at(" + to_string(floor) + ", " + to_string(bedrooms) + ")");
+        return rents[size_t(floor) * cols + bedrooms];
+    }
+
+    int lookup(int floor, int bedrooms) const {
+        if (unsigned(floor) >= unsigned(rows) || unsigned(bedrooms) >= unsigned(cols))
+            return NO_RENT;
+        return rents[size_t(floor) * cols + bedrooms];
+    }
+
+    // Answers count queries; out[i] = rent or NO_RENT. Returns how many
+    // queries were out of range. out must hold count ints.
+    size_t lookupBatch(const int* floors, const int* bedrooms, size_t count, int* out) const;
+
+    // Reads "floor bedrooms" pairs from in and writes one rent per line,
+    // batching chunk queries at a time through lookupBatch.
+    size_t answerStream(istream& in, ostream& out, size_t chunk = 1 << 16) const;
+
+    // force the portable kernel (used by the benchmark)
+    void setUseSimd(bool on) { useSimd = on && simdAvailable(); }
+    bool getUseSimd() const { return useSimd; }
+
+private:
+    int rows{};
+    int cols{};
+    vector<int> rents;   // row-major, floor * cols + bedrooms
+    bool useSimd{simdAvailable()};
+
+    // positive sizes whose product fits the 32-bit gather indexes
+    static bool validSize(long long r, long long c) { return r > 0 && c > 0 && r <= INT_MAX / c; }
+    static bool checkSize(int r, int c) {
+        if (!validSize(r, c)) throw invalid_argument("RentMatrix size " + to_string(r) + " x " + to_string(c));
+        return true;
+    }
+
+    static bool simdAvailable() {
+#ifdef HAVE_X86_KERNELS
+        return __builtin_cpu_supports("avx2");
+#else
+        return false;
+#endif
+    }
+    size_t lookupScalar(const int* f, const int* b, size_t n, int* out) const;
+#ifdef HAVE_X86_KERNELS
+    size_t lookupAvx2(const int* f, const int* b, size_t n, int* out) const;
+#endif
+};
+
+bool RentMatrix::load(istream& in) {
+    long long r, c;
+    if (!(in >> r >> c) || !validSize(r, c))
+        return false;
+    vector<int> data(size_t(r * c));
+    for (int& rent : data)
+        if (!(in >> rent) || rent < 0) return false;
+    rows = int(r);
+    cols = int(c);
+    rents.swap(data);
+    return true;
+}
+
+size_t RentMatrix::lookupScalar(const int* f, const int* b, size_t n, int* out) const {
+    size_t bad = 0;
+    for (size_t x = 0; x < n; ++x) {
+        bool ok = unsigned(f[x]) < unsigned(rows) && unsigned(b[x]) < unsigned(cols);
+        out[x] = ok ? rents[size_t(f[x]) * cols + b[x]] : NO_RENT;
+        bad += !ok;
+    }
+    return bad;
+}
+
+#ifdef HAVE_X86_KERNELS
+__attribute__((target("avx2")))
+size_t RentMatrix::lookupAvx2(const int* f, const int* b, size_t n, int* out) const {
+    const __m256i vRows = _mm256_set1_epi32(rows);
+    const __m256i vCols = _mm256_set1_epi32(cols);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i none = _mm256_set1_epi32(NO_RENT);
+    size_t bad = 0;
+    size_t x = 0;
+    for (; x + 8 <= n; x += 8) {
+        __m256i fl = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(f + x));
+        __m256i bd = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + x));
+        // 0 <= v < limit, done with signed compares
+        __m256i okF = _mm256_andnot_si256(_mm256_cmpgt_epi32(zero, fl),
+                                          _mm256_cmpgt_epi32(vRows, fl));
+        __m256i okB = _mm256_andnot_si256(_mm256_cmpgt_epi32(zero, bd),
+                                          _mm256_cmpgt_epi32(vCols, bd));
+        __m256i ok = _mm256_and_si256(okF, okB);
+        __m256i idx = _mm256_add_epi32(_mm256_mullo_epi32(fl, vCols), bd);
+        // masked-off lanes keep NO_RENT and are never read from memory
+        __m256i rent = _mm256_mask_i32gather_epi32(none, rents.data(), idx, ok, 4);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x), rent);
+        bad += 8 - __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(ok)));
+    }
+    return bad + lookupScalar(f + x, b + x, n - x, out + x);
+}
+#endif
+
+size_t RentMatrix::lookupBatch(const int* floors, const int* bedrooms,
+                               size_t count, int* out) const {
+#ifdef HAVE_X86_KERNELS
+    if (useSimd) return lookupAvx2(floors, bedrooms, count, out);
+#endif
+    return lookupScalar(floors, bedrooms, count, out);
+}
+
+size_t RentMatrix::answerStream(istream& in, ostream& out, size_t chunk) const {
+    vector<int> floors(chunk), bedrooms(chunk), rent(chunk);
+    string text;
+    size_t answered = 0;
+    for (;;) {
+        size_t n = 0;
+        while (n < chunk && in >> floors[n] >> bedrooms[n]) ++n;
+        if (n == 0) break;
+        lookupBatch(floors.data(), bedrooms.data(), n, rent.data());
+        // build one block of text per chunk instead of a write per answer
+        text.clear();
+        for (size_t x = 0; x < n; ++x) {
+            text += to_string(rent[x]);
+            text += '\n';
+        }
+        out.write(text.data(), streamsize(text.size()));
+        answered += n;
+    }
+    return answered;
+}
+
+int main(int argc, char* argv[]) {
+    RentMatrix rents;
+    if (argc > 1) {
+        if (!rents.loadFile(argv[1])) {
+            cout << "Could not load a rent table from " << argv[1] << endl;
+            return 1;
+        }
+    } else {
+        // the demo1-9 table in the on-disk format
+        istringstream table("4 3\n"
+                            "400 450 510\n"
+                            "500 560 630\n"
+                            "625 676 740\n"
+                            "1000 1250 1600\n");
+        rents.load(table);
+    }
+    cout << "Loaded a " << rents.getRows() << " x " << rents.getCols()
+         << " rent table" << endl;
+
+    // a few queries, including two that demo1-9 would read out of bounds
+    istringstream queries("0 0\n2 1\n3 2\n4 0\n1 -1\n");
+    cout << "Answers for floor/bedroom queries:" << endl;
+    rents.answerStream(queries, cout);
+
+    // ---- throughput on 10^7 queries, 1% out of range ----
+    const size_t N = 10000000;
+    RentMatrix big(1000, 8);
+    for (int f = 0; f < 1000; ++f)
+        for (int b = 0; b < 8; ++b)
+            big.at(f, b) = 400 + f * 10 + b * 75;
+
+    mt19937 rng(9);
+    uniform_int_distribution<int> floorDist(0, 1000 - 1), bedDist(0, 8 - 1), pct(0, 99);
+    vector<int> floors(N), bedrooms(N), out(N);
+    for (size_t x = 0; x < N; ++x) {
+        floors[x] = floorDist(rng);
+        bedrooms[x] = pct(rng) == 0 ? 8 : bedDist(rng);
+    }
+
+    cout << endl << fixed << setprecision(1);
+    for (bool simd : { false, true }) {
+        big.setUseSimd(simd);
+        if (simd && !big.getUseSimd()) break;
+        size_t bad = 0;
+        const int REPEAT = 5;
+        auto t = chrono::steady_clock::now();
+        for (int r = 0; r < REPEAT; ++r)
+            bad = big.lookupBatch(floors.data(), bedrooms.data(), N, out.data());
+        chrono::duration<double> s = chrono::steady_clock::now() - t;
+        cout << (simd ? "avx2 gather: " : "scalar:      ")
+             << (N * REPEAT) / s.count() / 1e6 << " M lookups/s, "
+             << bad << " out of range" << endl;
+    }
+    return 0;
+}
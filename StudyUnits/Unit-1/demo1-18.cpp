@@ -0,0 +1,228 @@
+// Bulk version of demo1-3 for multi-gigabyte price files. The input file
+// is memory-mapped and walked from its last byte to its first: each price
+// token is found by scanning backwards for whitespace, validated and
+// parsed in place with from_chars, and formatted with to_chars into a
+// large output buffer that is handed to write(2) only when it fills.
+// No second copy of the prices is ever materialized.
+//
+//   ./demo1-18 prices.txt > reversed.txt    reverse a file
+//   ./demo1-18                              benchmark against iostream
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+using namespace std;
+
+// -------------------------------------------------
+// MappedFile: read-only mapping, unmapped on scope exit
+// -------------------------------------------------
+class MappedFile {
+private:
+    const char* data{nullptr};
+    size_t length{};
+    bool opened{false};
+public:
+    explicit MappedFile(const char* path) {
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0) {
+            if (st.st_size == 0) {
+                opened = true;   // nothing to map: begin() == end()
+            } else {
+                void* p = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p != MAP_FAILED) {
+                    data = static_cast<const char*>(p);
+                    length = size_t(st.st_size);
+                    opened = true;
+                    madvise(p, length, MADV_WILLNEED);   // start read-ahead now
+                }
+            }
+        }
+        close(fd);   // the mapping stays valid after the descriptor closes
+    }
+    ~MappedFile() {
+        if (data) munmap(const_cast<char*>(data), length);
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isOpen() const { return opened; }
+    const char* begin() const { return data; }
+    const char* end() const { return data + length; }
+    size_t size() const { return length; }
+};
+
+// -------------------------------------------------
+// OutputBuffer: accumulates text, one write(2) per MiBs of output
+// -------------------------------------------------
+class OutputBuffer {
+private:
+    int fd;
+    vector<char> buf;
+    size_t used{};
+    int error{};   // errno of the first failed write, 0 if none
+public:
+    static const size_t CAPACITY = 8 << 20;
+    explicit OutputBuffer(int f) : fd(f), buf(CAPACITY) {}
+    ~OutputBuffer() { flush(); }
+
+    // reserve room for a token of at most n bytes
+    char* room(size_t n) {
+        if (used + n > buf.size()) flush();
+        return buf.data() + used;
+    }
+    void commit(char* tokenEnd) { used = size_t(tokenEnd - buf.data()); }
+    void put(char c) { *room(1) = c; ++used; }
+
+    // Writes everything buffered, retrying after EINTR. Returns false once
+    // any write has failed; the error sticks and later output is dropped.
+    bool flush() {
+        size_t done = 0;
+        while (done < used && error == 0) {
+            ssize_t n = write(fd, buf.data() + done, used - done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) error = n < 0 ? errno : EIO;
+            else done += size_t(n);
+        }
+        used = 0;
+        return error == 0;
+    }
+    int lastError() const { return error; }
+};
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+}
+
+// Emits every price in [first, last) in reverse order, separated by
+// spaces. Returns the number of prices written; tokens that are not a
+// valid double are skipped and counted in bad. The line ends in a newline
+// unless there were no prices, so an empty file gives empty output.
+size_t emitReversed(const char* first, const char* last, OutputBuffer& out, size_t& bad) {
+    size_t count = 0;
+    bad = 0;
+    const char* pos = last;
+    for (;;) {
+        while (pos > first && isSpace(pos[-1])) --pos;
+        if (pos == first) break;
+        const char* tokenEnd = pos;
+        while (pos > first && !isSpace(pos[-1])) --pos;
+
+        double price;
+        from_chars_result r = from_chars(pos, tokenEnd, price);
+        if (r.ec != errc() || r.ptr != tokenEnd) {
+            ++bad;
+            continue;
+        }
+        char* dst = out.room(32);   // shortest round-trip form always fits
+        dst = to_chars(dst, dst + 31, price).ptr;
+        *dst++ = ' ';
+        out.commit(dst);
+        ++count;
+    }
+    if (count) out.put('\n');
+    return count;
+}
+
+// ---------------- Benchmark helpers ----------------
+double seconds(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// demo1-3's approach: read every price with >>, then print in reverse
+size_t iostreamReverse(const char* path, const char* outPath) {
+    ifstream in(path);
+    ofstream out(outPath);
+    vector<double> price;
+    double p;
+    while (in >> p) price.push_back(p);
+    for (size_t sub = price.size(); sub-- > 0;)
+        out << price[sub] << " ";
+    out << endl;
+    return price.size();
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        MappedFile file(argv[1]);
+        if (!file.isOpen()) {
+            cerr << "Cannot map " << argv[1] << endl;
+            return 1;
+        }
+        OutputBuffer out(STDOUT_FILENO);
+        size_t bad;
+        emitReversed(file.begin(), file.end(), out, bad);
+        if (bad) cerr << bad << " malformed prices skipped" << endl;
+        if (!out.flush()) {
+            cerr << "Write failed: " << strerror(out.lastError()) << endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    // no file given: build a 10^7-price feed and time both approaches
+    const size_t NUM_PRICES = 10000000;
+    const char* path = "/tmp/demo1-18-prices.txt";
+    {
+        mt19937 rng(3);
+        uniform_int_distribution<int> cents(1, 999999);
+        int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            perror(path);
+            return 1;
+        }
+        OutputBuffer feed(fd);
+        for (size_t x = 0; x < NUM_PRICES; ++x) {
+            int c = cents(rng);
+            char* dst = feed.room(16);
+            dst += snprintf(dst, 16, "%d.%02d\n", c / 100, c % 100);
+            feed.commit(dst);
+        }
+        if (!feed.flush()) {
+            cerr << path << ": " << strerror(feed.lastError()) << endl;
+            return 1;
+        }
+    }
+
+    cout << fixed << setprecision(2);
+    auto t = chrono::steady_clock::now();
+    size_t n = iostreamReverse(path, "/dev/null");
+    double slow = seconds(t);
+
+    t = chrono::steady_clock::now();
+    size_t fast, bad;
+    {
+        MappedFile file(path);
+        int devNull = open("/dev/null", O_WRONLY);
+        if (devNull < 0) {
+            perror("/dev/null");
+            return 1;
+        }
+        OutputBuffer out(devNull);
+        fast = emitReversed(file.begin(), file.end(), out, bad);
+        out.flush();
+        close(devNull);
+    }
+    double quick = seconds(t);
+
+    MappedFile file(path);
+    double mb = double(file.size()) / (1 << 20);
+    cout << "iostream: " << n << " prices in " << slow << " s ("
+         << mb / slow << " MiB/s)" << endl;
+    cout << "mmap:     " << fast << " prices in " << quick << " s ("
+         << mb / quick << " MiB/s), " << bad << " malformed" << endl;
+    remove(path);
+    return 0;
+}
@@ -0,0 +1,341 @@
+// Aggregation kernels over the demo1-14 sales array: sum, min/max, mean,
+// prefix sum and a rolling 7-day window, for int32 and int64 sales.
+// Each kernel has a portable scalar version and an AVX2 version; the AVX2
+// versions are chosen once at runtime when the CPU supports them.
+// Sums are always accumulated in 64 bits so int32 data cannot overflow.
+//
+// The benchmark then answers demo1-14's question: does it matter whether
+// the array is walked as sales[x], p[x], *(sales + x), *(p + x) or p++?
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstddef>
+#if defined(__x86_64__)   // the 64-bit lane helpers need x86-64
+#include <immintrin.h>
+#define HAVE_X86_KERNELS 1
+#endif
+using namespace std;
+
+const int WINDOW = 7;   // days in the rolling window
+
+template <typename T>
+struct MinMax {
+    T min;
+    T max;
+};
+
+// -------------------------------------------------
+// Scalar kernels (any element type)
+// -------------------------------------------------
+template <typename T>
+int64_t sumScalar(const T* sales, size_t n) {
+    int64_t total = 0;
+    for (size_t x = 0; x < n; ++x) total += sales[x];
+    return total;
+}
+
+template <typename T>
+MinMax<T> minMaxScalar(const T* sales, size_t n) {
+    MinMax<T> r = { sales[0], sales[0] };
+    for (size_t x = 1; x < n; ++x) {
+        r.min = sales[x] < r.min ? sales[x] : r.min;
+        r.max = sales[x] > r.max ? sales[x] : r.max;
+    }
+    return r;
+}
+
+// out[x] = sales[0] + ... + sales[x]
+template <typename T>
+void prefixSumScalar(const T* sales, size_t n, int64_t* out, int64_t carry = 0) {
+    for (size_t x = 0; x < n; ++x) {
+        carry += sales[x];
+        out[x] = carry;
+    }
+}
+
+// out[x] = sales[x - 6] + ... + sales[x] for x >= 6 (n - 6 outputs)
+template <typename T>
+void rollingScalar(const T* sales, size_t n, int64_t* out) {
+    for (size_t x = WINDOW - 1; x < n; ++x) {
+        int64_t s = 0;
+        for (int k = 0; k < WINDOW; ++k) s += sales[x - k];
+        out[x - (WINDOW - 1)] = s;
+    }
+}
+
+#ifdef HAVE_X86_KERNELS
+// -------------------------------------------------
+// AVX2 kernels. Four int64 lanes are the unit of work; int32 input is
+// widened four elements at a time with vpmovsxdq.
+// -------------------------------------------------
+__attribute__((target("avx2")))
+inline __m256i load4(const int32_t* p) {
+    return _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+}
+__attribute__((target("avx2")))
+inline __m256i load4(const int64_t* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+__attribute__((target("avx2")))
+inline int64_t hsum(__m256i v) {
+    __m128i s = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    return _mm_cvtsi128_si64(s) + _mm_extract_epi64(s, 1);
+}
+
+template <typename T>
+__attribute__((target("avx2")))
+int64_t sumAvx2(const T* sales, size_t n) {
+    __m256i a = _mm256_setzero_si256(), b = _mm256_setzero_si256();
+    size_t x = 0;
+    for (; x + 8 <= n; x += 8) {            // two accumulators hide add latency
+        a = _mm256_add_epi64(a, load4(sales + x));
+        b = _mm256_add_epi64(b, load4(sales + x + 4));
+    }
+    return hsum(_mm256_add_epi64(a, b)) + sumScalar(sales + x, n - x);
+}
+
+__attribute__((target("avx2")))
+MinMax<int32_t> minMaxAvx2(const int32_t* sales, size_t n) {
+    if (n < 8) return minMaxScalar(sales, n);
+    __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sales));
+    __m256i hi = lo;
+    size_t x = 8;
+    for (; x + 8 <= n; x += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sales + x));
+        lo = _mm256_min_epi32(lo, v);
+        hi = _mm256_max_epi32(hi, v);
+    }
+    alignas(32) int32_t l[8], h[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(l), lo);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(h), hi);
+    MinMax<int32_t> r = { l[0], h[0] };
+    for (int k = 1; k < 8; ++k) {
+        r.min = min(r.min, l[k]);
+        r.max = max(r.max, h[k]);
+    }
+    for (; x < n; ++x) {
+        r.min = min(r.min, sales[x]);
+        r.max = max(r.max, sales[x]);
+    }
+    return r;
+}
+
+__attribute__((target("avx2")))
+MinMax<int64_t> minMaxAvx2(const int64_t* sales, size_t n) {
+    if (n < 4) return minMaxScalar(sales, n);
+    // AVX2 has no 64-bit min/max: compare, then blend
+    __m256i lo = load4(sales), hi = lo;
+    size_t x = 4;
+    for (; x + 4 <= n; x += 4) {
+        __m256i v = load4(sales + x);
+        lo = _mm256_blendv_epi8(lo, v, _mm256_cmpgt_epi64(lo, v));
+        hi = _mm256_blendv_epi8(hi, v, _mm256_cmpgt_epi64(v, hi));
+    }
+    alignas(32) int64_t l[4], h[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(l), lo);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(h), hi);
+    MinMax<int64_t> r = { l[0], h[0] };
+    for (int k = 1; k < 4; ++k) {
+        r.min = min(r.min, l[k]);
+        r.max = max(r.max, h[k]);
+    }
+    for (; x < n; ++x) {
+        r.min = min(r.min, sales[x]);
+        r.max = max(r.max, sales[x]);
+    }
+    return r;
+}
+
+template <typename T>
+__attribute__((target("avx2")))
+void prefixSumAvx2(const T* sales, size_t n, int64_t* out) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i carry = zero;   // running total broadcast to every lane
+    size_t x = 0;
+    for (; x + 4 <= n; x += 4) {
+        __m256i v = load4(sales + x);                                  // a b c d
+        __m256i s = _mm256_permute4x64_epi64(v, _MM_SHUFFLE(2, 1, 0, 0));
+        v = _mm256_add_epi64(v, _mm256_blend_epi32(s, zero, 0x03));    // a a+b b+c c+d
+        s = _mm256_permute4x64_epi64(v, _MM_SHUFFLE(1, 0, 0, 0));
+        v = _mm256_add_epi64(v, _mm256_blend_epi32(s, zero, 0x0F));    // inclusive scan
+        v = _mm256_add_epi64(v, carry);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x), v);
+        carry = _mm256_permute4x64_epi64(v, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    prefixSumScalar(sales + x, n - x, out + x, x ? out[x - 1] : 0);
+}
+
+template <typename T>
+__attribute__((target("avx2")))
+void rollingAvx2(const T* sales, size_t n, int64_t* out) {
+    if (n < size_t(WINDOW)) return;
+    size_t outputs = n - (WINDOW - 1);
+    size_t x = 0;
+    // four windows at once: seven unaligned loads, each one day further back
+    for (; x + 4 <= outputs; x += 4) {
+        __m256i s = load4(sales + x);
+        for (int k = 1; k < WINDOW; ++k)
+            s = _mm256_add_epi64(s, load4(sales + x + k));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x), s);
+    }
+    if (x < outputs)
+        rollingScalar(sales + x, n - x, out + x);
+}
+#endif
+
+// -------------------------------------------------
+// Public entry points: dispatch once per call on a cached CPU check
+// -------------------------------------------------
+bool useAvx2() {
+#ifdef HAVE_X86_KERNELS
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+template <typename T>
+int64_t salesSum(const T* sales, size_t n) {
+#ifdef HAVE_X86_KERNELS
+    if (useAvx2()) return sumAvx2(sales, n);
+#endif
+    return sumScalar(sales, n);
+}
+
+template <typename T>
+double salesMean(const T* sales, size_t n) {
+    return n ? double(salesSum(sales, n)) / double(n) : 0.0;
+}
+
+// n must be at least 1
+template <typename T>
+MinMax<T> salesMinMax(const T* sales, size_t n) {
+#ifdef HAVE_X86_KERNELS
+    if (useAvx2()) return minMaxAvx2(sales, n);
+#endif
+    return minMaxScalar(sales, n);
+}
+
+// out must hold n values
+template <typename T>
+void salesPrefixSum(const T* sales, size_t n, int64_t* out) {
+#ifdef HAVE_X86_KERNELS
+    if (useAvx2()) return prefixSumAvx2(sales, n, out);
+#endif
+    prefixSumScalar(sales, n, out);
+}
+
+// out must hold n - 6 values (one per complete 7-day window)
+template <typename T>
+void salesRolling7(const T* sales, size_t n, int64_t* out) {
+#ifdef HAVE_X86_KERNELS
+    if (useAvx2()) return rollingAvx2(sales, n, out);
+#endif
+    rollingScalar(sales, n, out);
+}
+
+// -------------------------------------------------
+// The five demo1-14 access styles, summing instead of printing
+// -------------------------------------------------
+int64_t byIndex(const int* sales, size_t n) {
+    int64_t s = 0;
+    for (size_t x = 0; x < n; x++) s += sales[x];
+    return s;
+}
+int64_t byPointerIndex(const int* p, size_t n) {
+    int64_t s = 0;
+    for (size_t x = 0; x < n; x++) s += p[x];
+    return s;
+}
+int64_t byArrayOffset(const int* sales, size_t n) {
+    int64_t s = 0;
+    for (size_t x = 0; x < n; x++) s += *(sales + x);
+    return s;
+}
+int64_t byPointerOffset(const int* p, size_t n) {
+    int64_t s = 0;
+    for (size_t x = 0; x < n; x++) s += *(p + x);
+    return s;
+}
+int64_t byIncrement(const int* p, size_t n) {
+    int64_t s = 0;
+    for (size_t x = 0; x < n; x++, p++) s += *p;
+    return s;
+}
+
+template <typename F>
+double nsPerElement(F f, const int* sales, size_t n, int64_t& check) {
+    // repeat small arrays so every measurement covers ~10^8 elements
+    size_t reps = max<size_t>(1, 100000000 / n);
+    auto t = chrono::steady_clock::now();
+    for (size_t r = 0; r < reps; ++r) {
+        asm volatile("" : : "r"(sales) : "memory");   // keep the loop honest
+        check += f(sales, n);
+    }
+    chrono::duration<double, nano> ns = chrono::steady_clock::now() - t;
+    return ns.count() / double(reps * n);
+}
+
+template <typename T>
+bool kernelsAgree(const vector<T>& sales) {
+    size_t n = sales.size();
+    vector<int64_t> a(n), b(n);
+    MinMax<T> m1 = salesMinMax(sales.data(), n), m2 = minMaxScalar(sales.data(), n);
+    salesPrefixSum(sales.data(), n, a.data());
+    prefixSumScalar(sales.data(), n, b.data());
+    bool ok = salesSum(sales.data(), n) == sumScalar(sales.data(), n) &&
+              m1.min == m2.min && m1.max == m2.max && a == b;
+    salesRolling7(sales.data(), n, a.data());
+    rollingScalar(sales.data(), n, b.data());
+    return ok && equal(a.begin(), a.begin() + (n - (WINDOW - 1)), b.begin());
+}
+
+int main() {
+    const int DAYS = 7;
+    int sales[DAYS] = { 500, 300, 450, 200, 525, 800, 1000 };
+    MinMax<int> mm = salesMinMax(sales, DAYS);
+    int64_t prefix[DAYS], week[1];
+    salesPrefixSum(sales, DAYS, prefix);
+    salesRolling7(sales, DAYS, week);
+    cout << "Kernels: " << (useAvx2() ? "avx2" : "scalar") << endl;
+    cout << "Total $" << salesSum(sales, DAYS) << "  mean $" << salesMean(sales, DAYS)
+         << "  min $" << mm.min << "  max $" << mm.max
+         << "  7-day window $" << week[0] << endl;
+    cout << "Running total:";
+    for (int x = 0; x < DAYS; x++) cout << " $" << prefix[x];
+    cout << endl;
+
+    mt19937 rng(14);
+    uniform_int_distribution<int> amount(0, 5000);
+    vector<int32_t> s32(1000003);
+    for (int32_t& v : s32) v = amount(rng);
+    vector<int64_t> s64(s32.begin(), s32.end());
+    s64[17] = INT64_MAX / 4;      // exercise values that only fit in 64 bits
+    cout << "SIMD kernels match scalar (int32/int64): "
+         << (kernelsAgree(s32) ? "yes" : "NO") << " / "
+         << (kernelsAgree(s64) ? "yes" : "NO") << endl;
+
+    cout << endl << fixed << setprecision(3)
+         << "ns per element     sales[x]     p[x] *(sales+x)   *(p+x)      p++   kernel" << endl;
+    int64_t check = 0;
+    for (size_t n : { size_t(7), size_t(1000), size_t(1000000), size_t(100000000) }) {
+        vector<int> data(n);
+        for (int& v : data) v = amount(rng);
+        cout << setw(14) << n
+             << setw(11) << nsPerElement(byIndex, data.data(), n, check)
+             << setw(9) << nsPerElement(byPointerIndex, data.data(), n, check)
+             << setw(11) << nsPerElement(byArrayOffset, data.data(), n, check)
+             << setw(9) << nsPerElement(byPointerOffset, data.data(), n, check)
+             << setw(9) << nsPerElement(byIncrement, data.data(), n, check)
+             << setw(9) << nsPerElement(salesSum<int>, data.data(), n, check) << endl;
+    }
+    cout << "(checksum " << check << ")" << endl;
+    return 0;
+}
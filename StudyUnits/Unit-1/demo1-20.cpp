@@ -0,0 +1,166 @@
+// InlineString<N>: a fixed-capacity name field that replaces demo1-10's
+// `char name[10]` (which `cin >> name` can overflow) and the heap-backed
+// std::string name members of the record classes.
+//   - holds at most N characters; longer input is truncated, never overflowed
+//   - never allocates: the characters live inside the object
+//   - trivially copyable, so records containing it copy with memcpy
+//   - unused bytes are always zero, so equality is one memcmp of the object
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <limits>
+#include <locale>
+#include <cstring>
+#include <cstddef>
+#include <type_traits>
+using namespace std;
+
+template <size_t N>
+class InlineString {
+    static_assert(N > 0 && N < 256, "length is stored in one byte");
+private:
+    char data[N + 1];     // always NUL-terminated, zero-filled after len
+    unsigned char len;
+public:
+    InlineString() { memset(this, 0, sizeof(*this)); }
+    InlineString(const char* s) : InlineString() { assign(s, strlen(s)); }
+    InlineString(const string& s) : InlineString() { assign(s.data(), s.size()); }
+
+    // Copies at most N characters; returns false if s had to be truncated
+    bool assign(const char* s, size_t n) {
+        size_t keep = n < N ? n : N;
+        memcpy(data, s, keep);
+        memset(data + keep, 0, N + 1 - keep);   // keep the padding canonical
+        len = static_cast<unsigned char>(keep);
+        return keep == n;
+    }
+
+    static constexpr size_t capacity() { return N; }
+    size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+    const char* c_str() const { return data; }
+    string str() const { return string(data, len); }
+
+    // == is a whole-object compare, which the zero padding makes exact;
+    // < orders the same len characters, so embedded NULs count in both
+    bool operator==(const InlineString& o) const { return memcmp(this, &o, sizeof(*this)) == 0; }
+    bool operator!=(const InlineString& o) const { return !(*this == o); }
+    bool operator<(const InlineString& o) const {
+        int c = memcmp(data, o.data, len < o.len ? len : o.len);
+        return c < 0 || (c == 0 && len < o.len);
+    }
+};
+
+// Reads one whitespace-delimited word the way the std::string extractor
+// does (sentry, skipws, width(), the stream's locale), keeping the first N
+// characters and discarding the rest of the word, so input can never run
+// past the buffer.
+template <size_t N>
+istream& operator>>(istream& in, InlineString<N>& s) {
+    istream::sentry ok(in);   // skips leading whitespace unless noskipws
+    if (!ok) return in;
+    const ctype<char>& ct = use_facet<ctype<char>>(in.getloc());
+    const size_t limit = in.width() > 0 ? size_t(in.width()) : numeric_limits<size_t>::max();
+    streambuf* sb = in.rdbuf();
+    ios::iostate state = ios::goodbit;
+    char buf[N];
+    size_t n = 0, read = 0;
+    for (int c = sb->sgetc(); read < limit; c = sb->snextc(), ++read) {
+        if (char_traits<char>::eq_int_type(c, char_traits<char>::eof())) {
+            state |= ios::eofbit;
+            break;
+        }
+        if (ct.is(ctype_base::space, char_traits<char>::to_char_type(c))) break;
+        if (n < N) buf[n++] = char_traits<char>::to_char_type(c);
+    }
+    in.width(0);
+    if (read == 0) state |= ios::failbit;
+    else s.assign(buf, n);
+    in.setstate(state);
+    return in;
+}
+
+template <size_t N>
+ostream& operator<<(ostream& out, const InlineString<N>& s) {
+    return out.write(s.c_str(), streamsize(s.size()));
+}
+
+// ---------------------------------------------------------------
+// The record classes can adopt it as a drop-in name field
+// ---------------------------------------------------------------
+typedef InlineString<23> Name;   // 25 bytes, smaller than std::string's 32-byte header
+
+struct StudentRecord {           // demo2-1's Student fields
+    int idNum;
+    Name lastName;
+    double gpa;
+};
+struct StudentRecordStd {
+    int idNum;
+    string lastName;
+    double gpa;
+};
+static_assert(is_trivially_copyable<Name>::value, "InlineString must be memcpy-able");
+static_assert(is_trivially_copyable<StudentRecord>::value, "so must records built on it");
+
+template <typename Record>
+void benchmark(const char* label, const vector<string>& names) {
+    const size_t n = names.size();
+    auto t = chrono::steady_clock::now();
+    vector<Record> a;
+    a.reserve(n);
+    for (size_t x = 0; x < n; ++x)
+        a.push_back(Record{ int(x), names[x], 3.0 });
+    chrono::duration<double, milli> build = chrono::steady_clock::now() - t;
+
+    t = chrono::steady_clock::now();
+    vector<Record> b(a);
+    chrono::duration<double, milli> copy = chrono::steady_clock::now() - t;
+
+    t = chrono::steady_clock::now();
+    size_t same = 0;
+    for (size_t x = 0; x + 1 < n; ++x)
+        same += a[x].lastName == b[x + 1].lastName;
+    chrono::duration<double, milli> cmp = chrono::steady_clock::now() - t;
+
+    cout << setw(12) << label << "  construct " << setw(8) << build.count()
+         << " ms  copy " << setw(8) << copy.count()
+         << " ms  compare " << setw(8) << cmp.count()
+         << " ms  (" << sizeof(Record) << " bytes/record, " << same << " equal)" << endl;
+}
+
+int main() {
+    // demo1-10 with a name longer than the buffer: it is truncated, not overflowed
+    InlineString<9> name;
+    istringstream input("Maximilianus Tan");
+    cout << "Enter a name ";
+    input >> name;
+    cout << endl << "You have entered " << name << " (" << name.size() << " of "
+         << name.capacity() << " characters kept)" << endl;
+
+    Name a("Santini"), b(string("Santini")), c("Smith");
+    cout << a << " == " << b << ": " << (a == b ? "yes" : "no") << ", "
+         << a << " == " << c << ": " << (a == c ? "yes" : "no") << endl;
+
+    // ---- 10^7 records, last names 3..20 characters drawn from a pool ----
+    const size_t RECORDS = 10000000;
+    mt19937 rng(10);
+    uniform_int_distribution<int> len(3, 20), letter('a', 'z');
+    vector<string> pool(5000);
+    for (string& s : pool) {
+        s.resize(size_t(len(rng)));
+        for (char& ch : s) ch = char(letter(rng));
+    }
+    uniform_int_distribution<size_t> pick(0, pool.size() - 1);
+    vector<string> names(RECORDS);
+    for (string& s : names) s = pool[pick(rng)];
+
+    cout << endl << fixed << setprecision(1);
+    benchmark<StudentRecordStd>("std::string", names);
+    benchmark<StudentRecord>("InlineString", names);
+    return 0;
+}
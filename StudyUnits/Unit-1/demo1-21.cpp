@@ -0,0 +1,341 @@
+// demo1-12 compares `oneName == anotherName` one character at a time.
+// A SymbolTable interns each distinct string once and hands out a Symbol,
+// a 32-bit ID, so name equality and hashing become integer operations.
+//
+// Thread safety:
+//   - lookups (find, and intern of an already-interned string) take no lock:
+//     they probe an open-addressing table of atomic slots
+//   - inserting a new string locks one of 64 shards; the string bytes go
+//     into that shard's append-only arena and the slot is published with a
+//     release store, so a reader that sees the slot also sees the string
+//   - a shard that fills up publishes a bigger table; old tables are kept
+//     until the SymbolTable is destroyed, so readers never touch freed memory
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <random>
+#include <chrono>
+#include <functional>
+#include <cstring>
+#include <cstdint>
+using namespace std;
+
+class Symbol {
+private:
+    uint32_t id;
+public:
+    static const uint32_t NONE = UINT32_MAX;
+    explicit Symbol(uint32_t i = NONE) : id(i) {}
+    uint32_t getId() const { return id; }
+    bool operator==(Symbol o) const { return id == o.id; }
+    bool operator!=(Symbol o) const { return id != o.id; }
+    bool operator<(Symbol o) const { return id < o.id; }   // interning order, not alphabetical
+};
+
+namespace std {
+template <> struct hash<Symbol> {
+    size_t operator()(Symbol s) const { return s.getId() * 0x9E3779B97F4A7C15ULL; }
+};
+}
+
+class SymbolTable {
+public:
+    struct Stats {
+        size_t symbols;
+        size_t stringBytes;     // characters actually interned
+        size_t arenaBytes;      // blocks reserved for them
+        size_t tableBytes;      // hash slots, including retired tables
+        size_t directoryBytes;  // id -> string entries
+        size_t total() const { return arenaBytes + tableBytes + directoryBytes; }
+    };
+
+    SymbolTable();
+    ~SymbolTable();
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
+    // Returns the symbol for s, adding it on first sight
+    Symbol intern(string_view s);
+    // Lock-free: returns false if s was never interned
+    bool find(string_view s, Symbol& out) const;
+    // Lock-free: the interned characters, valid for the table's lifetime.
+    // s must come from this table's intern() or find(); the default
+    // Symbol() and ids past size() give an empty string.
+    string_view str(Symbol s) const {
+        if (s.getId() >= size()) return string_view();
+        const Entry& e = entry(s.getId());
+        return string_view(e.chars, e.len);
+    }
+    size_t size() const { return nextId.load(memory_order_relaxed); }
+    Stats stats() const;
+
+private:
+    struct Entry {
+        const char* chars;
+        uint32_t len;
+        uint32_t hash;
+    };
+    struct Table {
+        size_t mask;
+        atomic<uint32_t>* slots;   // id + 1, or 0 for empty
+        explicit Table(size_t cap) : mask(cap - 1), slots(new atomic<uint32_t>[cap]) {
+            for (size_t x = 0; x < cap; ++x) slots[x].store(0, memory_order_relaxed);
+        }
+        ~Table() { delete[] slots; }
+    };
+    struct Shard {
+        mutex lock;
+        atomic<Table*> table{nullptr};
+        vector<Table*> tables;   // current one last; older ones are retired
+        size_t count{};
+        vector<char*> blocks;
+        size_t blockUsed{}, blockSize{};
+        size_t stringBytes{}, arenaBytes{};
+    };
+
+    static const int SHARD_BITS = 6;
+    static const size_t SHARDS = size_t(1) << SHARD_BITS;
+    static const uint32_t CHUNK_BITS = 16;          // 65536 entries per chunk
+    static const size_t CHUNKS = size_t(1) << (32 - CHUNK_BITS);
+    static const size_t BLOCK = 64 * 1024;          // arena block size
+
+    Shard shards[SHARDS];
+    atomic<Entry*>* chunks;                         // id >> CHUNK_BITS -> chunk
+    atomic<uint32_t> nextId{0};
+
+    static uint64_t hashOf(string_view s) { return hash<string_view>()(s) * 0x9E3779B97F4A7C15ULL; }
+    Shard& shardOf(uint64_t h) { return shards[h >> (64 - SHARD_BITS)]; }
+    const Shard& shardOf(uint64_t h) const { return shards[h >> (64 - SHARD_BITS)]; }
+
+    const Entry& entry(uint32_t id) const {
+        return chunks[id >> CHUNK_BITS].load(memory_order_acquire)[id & ((1u << CHUNK_BITS) - 1)];
+    }
+    bool probe(const Table* t, string_view s, uint64_t h, Symbol& out) const;
+    const char* store(Shard& sh, string_view s);
+    Entry& newEntry(uint32_t id);
+    void grow(Shard& sh);
+};
+
+SymbolTable::SymbolTable() : chunks(new atomic<Entry*>[CHUNKS]) {
+    for (size_t x = 0; x < CHUNKS; ++x) chunks[x].store(nullptr, memory_order_relaxed);
+    for (Shard& sh : shards) {
+        sh.tables.push_back(new Table(16));
+        sh.table.store(sh.tables.back(), memory_order_release);
+    }
+}
+
+SymbolTable::~SymbolTable() {
+    for (Shard& sh : shards) {
+        for (Table* t : sh.tables) delete t;
+        for (char* b : sh.blocks) delete[] b;
+    }
+    for (size_t x = 0; x < CHUNKS; ++x) delete[] chunks[x].load(memory_order_relaxed);
+    delete[] chunks;
+}
+
+bool SymbolTable::probe(const Table* t, string_view s, uint64_t h, Symbol& out) const {
+    uint32_t h32 = uint32_t(h);
+    for (size_t i = h & t->mask;; i = (i + 1) & t->mask) {
+        uint32_t v = t->slots[i].load(memory_order_acquire);
+        if (v == 0) return false;
+        const Entry& e = entry(v - 1);
+        if (e.hash == h32 && e.len == s.size() && memcmp(e.chars, s.data(), s.size()) == 0) {
+            out = Symbol(v - 1);
+            return true;
+        }
+    }
+}
+
+bool SymbolTable::find(string_view s, Symbol& out) const {
+    uint64_t h = hashOf(s);
+    const Shard& sh = shardOf(h);
+    return probe(sh.table.load(memory_order_acquire), s, h, out);
+}
+
+// copies the characters into the shard's arena (caller holds the lock)
+const char* SymbolTable::store(Shard& sh, string_view s) {
+    if (s.size() > BLOCK / 4) {                     // big strings get their own block
+        char* b = new char[s.size()];
+        sh.blocks.push_back(b);
+        sh.arenaBytes += s.size();
+        memcpy(b, s.data(), s.size());
+        return b;
+    }
+    if (sh.blockUsed + s.size() > sh.blockSize) {
+        sh.blocks.push_back(new char[BLOCK]);
+        sh.blockUsed = 0;
+        sh.blockSize = BLOCK;
+        sh.arenaBytes += BLOCK;
+    }
+    char* p = sh.blocks.back() + sh.blockUsed;
+    memcpy(p, s.data(), s.size());
+    sh.blockUsed += s.size();
+    return p;
+}
+
+SymbolTable::Entry& SymbolTable::newEntry(uint32_t id) {
+    atomic<Entry*>& slot = chunks[id >> CHUNK_BITS];
+    Entry* chunk = slot.load(memory_order_acquire);
+    if (!chunk) {   // first id in this chunk: any shard may get here, so race safely
+        Entry* fresh = new Entry[size_t(1) << CHUNK_BITS];
+        if (slot.compare_exchange_strong(chunk, fresh, memory_order_acq_rel))
+            chunk = fresh;
+        else
+            delete[] fresh;
+    }
+    return chunk[id & ((1u << CHUNK_BITS) - 1)];
+}
+
+// doubles the shard's table; readers keep using the old one until the swap
+void SymbolTable::grow(Shard& sh) {
+    Table* old = sh.tables.back();
+    Table* t = new Table((old->mask + 1) * 2);
+    for (size_t x = 0; x <= old->mask; ++x) {
+        uint32_t v = old->slots[x].load(memory_order_relaxed);
+        if (v == 0) continue;
+        const Entry& e = entry(v - 1);
+        uint64_t h = hashOf(string_view(e.chars, e.len));
+        size_t i = h & t->mask;
+        while (t->slots[i].load(memory_order_relaxed) != 0) i = (i + 1) & t->mask;
+        t->slots[i].store(v, memory_order_relaxed);
+    }
+    sh.tables.push_back(t);
+    sh.table.store(t, memory_order_release);
+}
+
+Symbol SymbolTable::intern(string_view s) {
+    uint64_t h = hashOf(s);
+    Shard& sh = shardOf(h);
+    Symbol sym;
+    if (probe(sh.table.load(memory_order_acquire), s, h, sym))
+        return sym;   // the common case: already interned, no lock taken
+
+    lock_guard<mutex> guard(sh.lock);
+    if (probe(sh.tables.back(), s, h, sym))
+        return sym;   // another thread added it while we waited
+    if ((sh.count + 1) * 4 > (sh.tables.back()->mask + 1) * 3)
+        grow(sh);
+
+    uint32_t id = nextId.fetch_add(1, memory_order_relaxed);
+    Entry& e = newEntry(id);
+    e.chars = store(sh, s);
+    e.len = uint32_t(s.size());
+    e.hash = uint32_t(h);
+    sh.stringBytes += s.size();
+    ++sh.count;
+
+    Table* t = sh.tables.back();
+    size_t i = h & t->mask;
+    while (t->slots[i].load(memory_order_relaxed) != 0) i = (i + 1) & t->mask;
+    t->slots[i].store(id + 1, memory_order_release);   // publishes e as well
+    return Symbol(id);
+}
+
+SymbolTable::Stats SymbolTable::stats() const {
+    Stats st = { size(), 0, 0, 0, 0 };
+    for (const Shard& sh : shards) {
+        lock_guard<mutex> guard(const_cast<mutex&>(sh.lock));
+        st.stringBytes += sh.stringBytes;
+        st.arenaBytes += sh.arenaBytes;
+        for (const Table* t : sh.tables)
+            st.tableBytes += (t->mask + 1) * sizeof(atomic<uint32_t>);
+    }
+    size_t chunksUsed = (st.symbols + (size_t(1) << CHUNK_BITS) - 1) >> CHUNK_BITS;
+    st.directoryBytes = CHUNKS * sizeof(atomic<Entry*>) +
+                        chunksUsed * (sizeof(Entry) << CHUNK_BITS);
+    return st;
+}
+
+// ---------------------------------------------------------------
+double seconds(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    SymbolTable names;
+
+    // demo1-12, with symbols in place of strings
+    Symbol oneName = names.intern("John");
+    Symbol anotherName = names.intern("John");
+    cout << names.str(oneName) << " and " << names.str(anotherName) << " are "
+         << (oneName == anotherName ? "equal" : "different") << endl;
+    anotherName = names.intern("Nicholas");
+    cout << names.str(oneName) << " and " << names.str(anotherName) << " are "
+         << (oneName == anotherName ? "equal" : "different") << endl;
+    oneName = anotherName;
+    cout << names.str(oneName) << " and " << names.str(anotherName) << " are "
+         << (oneName == anotherName ? "equal" : "different") << endl;
+
+    // ---- 10^7 inserts drawn from 10^6 distinct last names (90% duplicates) ----
+    const size_t INSERTS = 10000000, DISTINCT = INSERTS / 10;
+    mt19937 rng(12);
+    uniform_int_distribution<int> len(4, 14), letter('a', 'z');
+    vector<string> pool(DISTINCT);
+    for (size_t x = 0; x < DISTINCT; ++x) {
+        pool[x].resize(size_t(len(rng)));
+        for (char& c : pool[x]) c = char(letter(rng));
+        pool[x] += to_string(x);      // keeps every pool entry distinct
+    }
+    vector<uint32_t> draw(INSERTS);
+    for (uint32_t& d : draw) d = uint32_t(rng() % DISTINCT);
+
+    unsigned numThreads = max(4u, thread::hardware_concurrency());
+    SymbolTable table;
+    vector<Symbol> got(INSERTS);
+    auto t = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (unsigned w = 0; w < numThreads; ++w)
+        workers.emplace_back([&, w] {
+            for (size_t x = w; x < INSERTS; x += numThreads)
+                got[x] = table.intern(pool[draw[x]]);
+        });
+    for (thread& th : workers) th.join();
+    double internSec = seconds(t);
+
+    // every occurrence of a name must have received the same symbol
+    vector<Symbol> first(DISTINCT);
+    size_t conflicts = 0;
+    for (size_t x = 0; x < INSERTS; ++x) {
+        Symbol& f = first[draw[x]];
+        if (f == Symbol()) f = got[x];
+        else conflicts += f != got[x];
+    }
+
+    t = chrono::steady_clock::now();
+    size_t hits = 0;
+    for (size_t x = 0; x < INSERTS; ++x) {
+        Symbol s;
+        hits += table.find(pool[draw[x]], s);
+    }
+    double findSec = seconds(t);
+
+    t = chrono::steady_clock::now();
+    size_t eqStr = 0;
+    for (size_t x = 0; x + 1 < INSERTS; ++x) eqStr += pool[draw[x]] == pool[draw[x + 1]];
+    double strSec = seconds(t);
+    t = chrono::steady_clock::now();
+    size_t eqSym = 0;
+    for (size_t x = 0; x + 1 < INSERTS; ++x) eqSym += got[x] == got[x + 1];
+    double symSec = seconds(t);
+
+    SymbolTable::Stats st = table.stats();
+    cout << endl << fixed << setprecision(1);
+    cout << numThreads << " threads interned " << INSERTS << " names in " << internSec
+         << " s (" << INSERTS / internSec / 1e6 << " M/s), " << st.symbols
+         << " distinct, " << conflicts << " conflicting ids" << endl;
+    cout << "lock-free find: " << INSERTS / findSec / 1e6 << " M/s (" << hits << " hits)" << endl;
+    cout << "string ==: " << strSec * 1e3 << " ms   Symbol ==: " << symSec * 1e3
+         << " ms   (" << eqStr << " / " << eqSym << " equal)" << endl;
+    cout << "memory: " << st.total() / 1048576.0 << " MiB total = "
+         << st.arenaBytes / 1048576.0 << " arena (" << st.stringBytes / 1048576.0
+         << " chars) + " << st.tableBytes / 1048576.0 << " hash slots + "
+         << st.directoryBytes / 1048576.0 << " directory" << endl;
+    cout << "vs. " << INSERTS << " std::string copies: at least "
+         << INSERTS * sizeof(string) / 1048576.0 << " MiB" << endl;
+    return 0;
+}
@@ -0,0 +1,160 @@
+// The constant arrays of demo1-2 (arrayInt), demo1-7 (partNum/partPrice)
+// and demo1-9 (rents), built and validated by the compiler instead of in
+// main(). A table that breaks its rules (unsorted part numbers, a ragged
+// or non-positive rent grid) is a compile error, so nothing is checked at
+// runtime, and a lookup with a constant key folds to a constant.
+// The static_asserts below only compile if the tables were evaluated at
+// compile time.
+#include <iostream>
+#include <cstddef>
+#include <type_traits>
+using namespace std;
+
+// Called during constant evaluation, a throw is a compile error that
+// shows the message; it can never run since all tables are constexpr.
+constexpr void require(bool ok, const char* why) {
+    if (!ok) throw why;
+}
+
+// ---------------- demo1-2: arrayInt ----------------
+template <size_t N>
+struct IntArray {
+    int value[N]{};
+    constexpr int operator[](size_t x) const { return value[x]; }
+};
+
+// increment then double element x, as demo1-2 does to arrayInt[0]
+template <size_t N>
+constexpr IntArray<N> incrementThenDouble(IntArray<N> a, size_t x) {
+    ++a.value[x];
+    a.value[x] = a.value[x] * 2;
+    return a;
+}
+
+constexpr IntArray<5> ARRAY_INT = { {12, 36} };   // remaining elements are 0
+constexpr IntArray<5> ARRAY_INT_DONE = incrementThenDouble(ARRAY_INT, 0);
+
+// ---------------- demo1-7: parts ----------------
+template <size_t N>
+class PartTable {
+private:
+    int partNum[N]{};
+    double partPrice[N]{};
+public:
+    constexpr PartTable(const int (&nums)[N], const double (&prices)[N]) {
+        for (size_t x = 0; x < N; ++x) {
+            require(x == 0 || nums[x - 1] < nums[x], "part numbers must be strictly ascending");
+            require(prices[x] > 0.0, "every part needs a positive price");
+            partNum[x] = nums[x];
+            partPrice[x] = prices[x];
+        }
+    }
+    static constexpr size_t size() { return N; }
+
+    // index of neededPart, or N when there is no such part
+    constexpr size_t indexOf(int neededPart) const {
+        size_t lo = 0, hi = N;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (partNum[mid] < neededPart) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo < N && partNum[lo] == neededPart ? lo : N;
+    }
+    constexpr bool hasPart(int neededPart) const { return indexOf(neededPart) != N; }
+    // 0.0 when there is no such part
+    constexpr double findPrice(int neededPart) const {
+        size_t x = indexOf(neededPart);
+        return x == N ? 0.0 : partPrice[x];
+    }
+};
+
+constexpr int PART_NUMS[] = { 210, 312, 367, 456 };
+constexpr double PART_PRICES[] = { 1.29, 2.45, 5.99, 1.42 };
+constexpr PartTable<4> PARTS(PART_NUMS, PART_PRICES);
+
+// ---------------- demo1-9: rents ----------------
+// Column b holds the rent of a b-bedroom unit; a studio (b = 0) counts
+// as one room when the price per bedroom is derived.
+template <size_t FLOORS, size_t BEDROOMS>
+class RentTable {
+private:
+    int rent[FLOORS][BEDROOMS]{};
+    double perBedroom[FLOORS][BEDROOMS]{};   // derived column
+public:
+    // the array reference only binds to a grid of exactly FLOORS x BEDROOMS
+    constexpr RentTable(const int (&rents)[FLOORS][BEDROOMS]) {
+        for (size_t f = 0; f < FLOORS; ++f)
+            for (size_t b = 0; b < BEDROOMS; ++b) {
+                require(rents[f][b] > 0, "rents must be positive");
+                require(b == 0 || rents[f][b - 1] <= rents[f][b],
+                        "more bedrooms must never be cheaper");
+                rent[f][b] = rents[f][b];
+                perBedroom[f][b] = double(rents[f][b]) / double(b == 0 ? 1 : b);
+            }
+    }
+    static constexpr size_t floors() { return FLOORS; }
+    static constexpr size_t bedrooms() { return BEDROOMS; }
+
+    constexpr bool inRange(size_t floor, size_t beds) const {
+        return floor < FLOORS && beds < BEDROOMS;
+    }
+    // -1 when the floor or bedroom count is out of range
+    constexpr int cost(size_t floor, size_t beds) const {
+        return inRange(floor, beds) ? rent[floor][beds] : -1;
+    }
+    constexpr double costPerBedroom(size_t floor, size_t beds) const {
+        return inRange(floor, beds) ? perBedroom[floor][beds] : -1.0;
+    }
+};
+
+constexpr int RENT_GRID[4][3] = {
+    { 400, 450, 510 },
+    { 500, 560, 630 },
+    { 625, 676, 740 },
+    { 1000, 1250, 1600 }
+};
+constexpr RentTable<4, 3> RENTS(RENT_GRID);
+
+// ---------------- compile-time proof ----------------
+// Each of these needs the table's value while compiling.
+static_assert(ARRAY_INT_DONE[0] == 26 && ARRAY_INT_DONE[1] == 36 && ARRAY_INT_DONE[4] == 0,
+              "demo1-2 arithmetic folds at compile time");
+static_assert(PARTS.findPrice(367) == 5.99, "part lookup folds to a constant");
+static_assert(!PARTS.hasPart(999) && PARTS.indexOf(456) == 3, "missing parts are known too");
+static_assert(RENTS.cost(3, 2) == 1600 && RENTS.cost(4, 0) == -1, "rent lookup is bounds-checked");
+static_assert(RENTS.costPerBedroom(2, 2) == 370.0, "derived column is precomputed");
+static_assert(is_same<integral_constant<int, RENTS.cost(1, 1)>,
+                      integral_constant<int, 560>>::value,
+              "usable as a template argument, so it is a constant expression");
+
+// Uncommenting either line fails to compile:
+// constexpr PartTable<2> BAD_PARTS({ 312, 210 }, { 1.0, 2.0 });   // unsorted
+// constexpr RentTable<2, 2> BAD_RENTS({ { 400, 300 }, { 1, 2 } });   // cheaper with more rooms
+
+int main() {
+    cout << "After incrementing and doubling, first array element is "
+         << ARRAY_INT_DONE[0] << endl;
+
+    int neededPart;
+    cout << "Enter the part number you want: ";
+    if (cin >> neededPart) {
+        // runtime key: a 2-step binary search over a table already in .rodata
+        if (PARTS.hasPart(neededPart))
+            cout << "The price is " << PARTS.findPrice(neededPart) << endl;
+        else
+            cout << "Sorry -- no such part number." << endl;
+    }
+
+    size_t floor, bedrooms;
+    cout << "What floor do you want ? ";
+    cin >> floor;
+    cout << "How many bedrooms you want ? ";
+    cin >> bedrooms;
+    if (cin && RENTS.inRange(floor, bedrooms))
+        cout << "The cost is $" << RENTS.cost(floor, bedrooms)
+             << " ($" << RENTS.costPerBedroom(floor, bedrooms) << " per bedroom)" << endl;
+    else
+        cout << "There is no such apartment." << endl;
+    return 0;
+}
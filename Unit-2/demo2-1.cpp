@@ -1,6 +1,7 @@
 // student_encapsulation.cpp
 #include <iostream>
 #include <string>
+#include <utility>
 using namespace std;
 
 class Student {
@@ -11,10 +12,11 @@ private:
 public:
     // simple mutators/accessors (public API hides private data)
     void setId(int id) { idNum = id; }
-    void setLastName(const string& ln) { lastName = ln; }
+    // sink parameter: a temporary name is moved in, an lvalue is copied once
+    void setLastName(string ln) { lastName = std::move(ln); }
     void setGpa(double v) { gpa = v; }
     int getId() const { return idNum; }
-    string getLastName() const { return lastName; }
+    const string& getLastName() const { return lastName; }  // no copy on read
     double getGpa() const { return gpa; }
 
     void displayStudentData(); // declaration only here
@@ -32,4 +34,5 @@ int main() {
     s.setLastName("Tan");
     s.setGpa(3.85);
     s.displayStudentData();
+    return 0;
 }
@@ -0,0 +1,241 @@
+// student_table_columns.cpp
+// Columnar storage for demo2-1's Student (idNum, lastName, gpa).
+// Each field is its own contiguous column: int32 ids, float GPAs and a
+// dictionary-encoded last name (one uint32 code per row, each distinct
+// name stored once). A GPA range query scans only the GPA column and
+// produces a selection vector: the row numbers of every match.
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_KERNELS 1
+#endif
+using namespace std;
+
+class StudentTable {
+private:
+    vector<int32_t> idNum;
+    vector<float> gpa;
+    vector<uint32_t> lastNameCode;          // index into names
+    vector<string> names;                   // dictionary: code -> last name
+    unordered_map<string, uint32_t> codes;  // dictionary: last name -> code
+    bool sortedByGpa{true};
+
+    uint32_t encode(const string& ln) {
+        auto it = codes.find(ln);
+        if (it != codes.end()) return it->second;
+        uint32_t code = uint32_t(names.size());
+        names.push_back(ln);
+        codes.emplace(ln, code);
+        return code;
+    }
+    size_t filterScalar(float lo, float hi, uint32_t* sel) const;
+#ifdef HAVE_X86_KERNELS
+    size_t filterAvx2(float lo, float hi, uint32_t* sel) const;
+#endif
+public:
+    void reserve(size_t n) {
+        idNum.reserve(n);
+        gpa.reserve(n);
+        lastNameCode.reserve(n);
+    }
+    void append(int id, const string& ln, float g) {
+        if (!gpa.empty() && g < gpa.back()) sortedByGpa = false;
+        idNum.push_back(id);
+        lastNameCode.push_back(encode(ln));
+        gpa.push_back(g);
+    }
+    // bulk append from parallel arrays
+    void append(const int32_t* ids, const string* lns, const float* gs, size_t n) {
+        reserve(size() + n);
+        for (size_t x = 0; x < n; ++x) append(ids[x], lns[x], gs[x]);
+    }
+
+    size_t size() const { return idNum.size(); }
+    size_t distinctNames() const { return names.size(); }
+    int getId(uint32_t row) const { return idNum[row]; }
+    const string& getLastName(uint32_t row) const { return names[lastNameCode[row]]; }
+    float getGpa(uint32_t row) const { return gpa[row]; }
+
+    void sortByGpa();
+
+    // Writes the rows with lo <= gpa <= hi into sel (room for size() rows)
+    // and returns how many there are.
+    size_t selectGpaRange(float lo, float hi, uint32_t* sel) const;
+
+    size_t columnBytes() const {
+        return idNum.size() * sizeof(int32_t) + gpa.size() * sizeof(float) +
+               lastNameCode.size() * sizeof(uint32_t);
+    }
+    size_t dictionaryBytes() const {
+        size_t b = 0;
+        for (const string& s : names) b += sizeof(string) + (s.size() > 15 ? s.capacity() : 0);
+        return b + codes.size() * (sizeof(string) + sizeof(uint32_t) + 2 * sizeof(void*));
+    }
+
+    void displayStudentData(uint32_t row) const {
+        cout << "Student #" << idNum[row] << " last name: " << getLastName(row) << "\n";
+        cout << "GPA: " << gpa[row] << "\n";
+    }
+};
+
+void StudentTable::sortByGpa() {
+    if (sortedByGpa) return;
+    vector<uint32_t> order(size());
+    iota(order.begin(), order.end(), 0);
+    stable_sort(order.begin(), order.end(),
+                [this](uint32_t a, uint32_t b) { return gpa[a] < gpa[b]; });
+    // gather each column through the permutation
+    vector<int32_t> ids(size());
+    vector<float> gs(size());
+    vector<uint32_t> lns(size());
+    for (size_t x = 0; x < order.size(); ++x) {
+        ids[x] = idNum[order[x]];
+        gs[x] = gpa[order[x]];
+        lns[x] = lastNameCode[order[x]];
+    }
+    idNum.swap(ids);
+    gpa.swap(gs);
+    lastNameCode.swap(lns);
+    sortedByGpa = true;
+}
+
+size_t StudentTable::filterScalar(float lo, float hi, uint32_t* sel) const {
+    size_t k = 0;
+    for (size_t x = 0; x < gpa.size(); ++x) {
+        sel[k] = uint32_t(x);                     // always write, advance on a match
+        k += (gpa[x] >= lo) & (gpa[x] <= hi);
+    }
+    return k;
+}
+
+#ifdef HAVE_X86_KERNELS
+// For each 8-bit match mask, the lane order that packs the matches first.
+struct CompressTable {
+    alignas(32) int32_t lanes[256][8];
+    CompressTable() {
+        for (int m = 0; m < 256; ++m) {
+            int k = 0;
+            for (int b = 0; b < 8; ++b)
+                if (m & (1 << b)) lanes[m][k++] = b;
+            while (k < 8) lanes[m][k++] = 0;
+        }
+    }
+};
+static const CompressTable COMPRESS;
+
+__attribute__((target("avx2")))
+size_t StudentTable::filterAvx2(float lo, float hi, uint32_t* sel) const {
+    const __m256 vLo = _mm256_set1_ps(lo), vHi = _mm256_set1_ps(hi);
+    const __m256i step = _mm256_set1_epi32(8);
+    __m256i rows = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const size_t n = gpa.size();
+    size_t k = 0, x = 0;
+    for (; x + 8 <= n; x += 8) {
+        __m256 g = _mm256_loadu_ps(gpa.data() + x);
+        __m256 in = _mm256_and_ps(_mm256_cmp_ps(g, vLo, _CMP_GE_OQ),
+                                  _mm256_cmp_ps(g, vHi, _CMP_LE_OQ));
+        int mask = _mm256_movemask_ps(in);
+        __m256i perm = _mm256_load_si256(reinterpret_cast<const __m256i*>(COMPRESS.lanes[mask]));
+        // sel has room for n rows and k <= x, so the full 8-lane store is safe
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(sel + k),
+                            _mm256_permutevar8x32_epi32(rows, perm));
+        k += size_t(__builtin_popcount(unsigned(mask)));
+        rows = _mm256_add_epi32(rows, step);
+    }
+    for (; x < n; ++x) {
+        sel[k] = uint32_t(x);
+        k += (gpa[x] >= lo) & (gpa[x] <= hi);
+    }
+    return k;
+}
+#endif
+
+size_t StudentTable::selectGpaRange(float lo, float hi, uint32_t* sel) const {
+    if (sortedByGpa) {
+        // sorted column: the answer is one contiguous run of rows
+        size_t first = size_t(lower_bound(gpa.begin(), gpa.end(), lo) - gpa.begin());
+        size_t last = size_t(upper_bound(gpa.begin(), gpa.end(), hi) - gpa.begin());
+        for (size_t x = first; x < last; ++x) sel[x - first] = uint32_t(x);
+        return last > first ? last - first : 0;
+    }
+#ifdef HAVE_X86_KERNELS
+    if (__builtin_cpu_supports("avx2")) return filterAvx2(lo, hi, sel);
+#endif
+    return filterScalar(lo, hi, sel);
+}
+
+// the demo2-1 layout, for the memory comparison
+struct Student {
+    int idNum;
+    string lastName;
+    double gpa;
+};
+
+double seconds(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    StudentTable demo;
+    demo.append(1001, "Tan", 3.85f);
+    demo.append(1002, "Lim", 3.20f);
+    demo.append(1003, "Tan", 3.95f);
+    vector<uint32_t> sel(demo.size());
+    size_t n = demo.selectGpaRange(3.5f, 4.0f, sel.data());
+    for (size_t x = 0; x < n; ++x) demo.displayStudentData(sel[x]);
+
+    // ---- benchmark: 10^7 rows by default, e.g. 50000000 on the command line ----
+    size_t rows = argc > 1 ? strtoull(argv[1], nullptr, 10) : 10000000;
+    mt19937 rng(21);
+    uniform_real_distribution<float> g(0.0f, 4.0f);
+    vector<string> surnames(20000);
+    for (size_t x = 0; x < surnames.size(); ++x) surnames[x] = "Name" + to_string(x * 7919 % 100003);
+    uniform_int_distribution<size_t> pick(0, surnames.size() - 1);
+
+    StudentTable table;
+    table.reserve(rows);
+    auto t = chrono::steady_clock::now();
+    for (size_t x = 0; x < rows; ++x)
+        table.append(int(x), surnames[pick(rng)], g(rng));
+    double appendSec = seconds(t);
+
+    sel.resize(rows);
+    size_t sortedHits = 0, hits = 0;
+    const int REPEAT = 10;
+    t = chrono::steady_clock::now();
+    for (int r = 0; r < REPEAT; ++r) hits = table.selectGpaRange(3.5f, 4.0f, sel.data());
+    double filterSec = seconds(t) / REPEAT;
+    uint32_t firstHit = hits ? sel[0] : 0;
+
+    t = chrono::steady_clock::now();
+    table.sortByGpa();
+    double sortSec = seconds(t);
+    t = chrono::steady_clock::now();
+    for (int r = 0; r < REPEAT; ++r) sortedHits = table.selectGpaRange(3.5f, 4.0f, sel.data());
+    double sortedSec = seconds(t) / REPEAT;
+
+    size_t gpaBytes = rows * sizeof(float);
+    size_t perRow = sizeof(Student);
+    cout << endl << fixed << setprecision(3);
+    cout << rows << " students, " << table.distinctNames() << " distinct last names" << endl;
+    cout << "append: " << appendSec << " s   sort by GPA: " << sortSec << " s" << endl;
+    cout << "gpa in [3.5, 4.0], unsorted: " << hits << " rows in " << filterSec * 1e3
+         << " ms (" << gpaBytes / filterSec / 1e9 << " GB/s of GPA column), first row "
+         << firstHit << endl;
+    cout << "gpa in [3.5, 4.0], sorted:   " << sortedHits << " rows in " << sortedSec * 1e3
+         << " ms" << endl;
+    cout << "memory: " << double(table.columnBytes() + table.dictionaryBytes()) / rows
+         << " bytes/student as columns vs " << perRow
+         << " bytes/student (plus any heap name) as Student objects" << endl;
+    return 0;
+}
@@ -0,0 +1,154 @@
+// accessor_allocations.cpp
+// Counts heap allocations to show what the const& getters and by-value
+// sink setters of demo2-1, demo2-3 and the Unit-4 Person classes
+// (demo-4-1, demo-4-3, demo-4-4) buy us; it compiles those demos in, so
+// it checks their actual classes. Reading 10^6 names through
+// a by-value getter allocates once per read (names longer than the small-
+// string buffer); through a const string& getter it allocates nothing.
+// Exits with status 1 if the read loop or a moved-in setter allocates.
+#include <iostream>
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdlib>
+#include <new>
+using namespace std;
+
+// ---- global allocation counter ----
+static size_t allocations = 0;
+
+void* operator new(size_t n) {
+    ++allocations;
+    if (void* p = malloc(n ? n : 1)) return p;
+    throw bad_alloc();
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+// The real classes: demo2-1's Student and demo2-3's Customer, with each
+// demo's main renamed so this file can have its own
+#define main student_encapsulation_main
+#include "demo2-1.cpp"
+#undef main
+#define main customer_scope_resolution_main
+#include "demo2-3.cpp"
+#undef main
+
+// The Unit-4 Persons all share class names, so each gets a namespace
+#define main person_demo_main
+namespace unit4_1 {
+#include "../Unit-4/demo-4-1.cpp"
+}
+namespace unit4_3 {
+#include "../Unit-4/demo-4-3.cpp"
+}
+namespace unit4_4 {
+#include "../Unit-4/demo-4-4.cpp"
+}
+#undef main
+
+// Allocations made by reading both names of every Person in people
+template <typename P>
+size_t nameReadAllocations(const vector<P>& people, size_t& total) {
+    size_t before = allocations;
+    for (const P& p : people) total += p.getLastName().size() + p.getFirstName().size();
+    return allocations - before;
+}
+
+// Fills people with long names, then counts the allocations of one more
+// setFields from rvalues and from lvalues. The new names are no longer
+// than the old ones, so a const string& setter copies them into the
+// existing storage, while a by-value one must copy an lvalue first.
+template <typename P, typename... Extra>
+void personSetterAllocations(vector<P>& people, const string& base, size_t& moved, size_t& copied,
+                             Extra... extra) {
+    for (size_t x = 0; x < people.size(); ++x)
+        people[x].setFields(int(x), base + to_string(x), base + "first", extra...);
+    string last = base + "L", first = base + "G";
+    size_t before = allocations;
+    people[0].setFields(0, std::move(last), std::move(first), extra...);
+    moved = allocations - before;
+    const string lvalueLast = base + "l", lvalueFirst = base + "g";
+    before = allocations;
+    people[1].setFields(1, lvalueLast, lvalueFirst, extra...);
+    copied = allocations - before;
+}
+
+// the old API, kept for comparison
+class OldCustomer {
+private:
+    string name;
+    double balance{};
+public:
+    void setName(string n) { name = std::move(n); }
+    string getName() { return name; }
+};
+
+int main() {
+    const size_t RECORDS = 1000000;
+    // long enough that std::string must use the heap
+    const string base = "Customer-with-a-long-name-";
+
+    vector<Customer> customers(RECORDS);
+    vector<OldCustomer> oldCustomers(RECORDS);
+    vector<Student> students(RECORDS);
+    for (size_t x = 0; x < RECORDS; ++x) {
+        string n = base + to_string(x);
+        customers[x].setName(n);            // lvalue: one copy
+        oldCustomers[x].setName(n);
+        students[x].setLastName(std::move(n));   // rvalue: moved, no allocation
+    }
+
+    // setters: count exactly what each call allocates
+    string lvalue = base + "lvalue";
+    string temporary = base + "temporary";
+    size_t before = allocations;
+    customers[0].setName(std::move(temporary)); // moved in: no allocation
+    size_t tempCost = allocations - before;
+    before = allocations;
+    customers[1].setName(lvalue);               // at most one, for the copy
+    size_t lvalueCost = allocations - before;
+
+    // read loops
+    size_t total = 0;
+    before = allocations;
+    for (OldCustomer& c : oldCustomers) total += c.getName().size();
+    size_t oldReads = allocations - before;
+
+    before = allocations;
+    for (const Customer& c : customers) total += c.getName().size();
+    for (const Student& s : students) total += s.getLastName().size();
+    size_t newReads = allocations - before;
+
+    // the Unit-4 Persons: demo-4-1's Customer takes const string&, so
+    // resetting it from lvalues reuses its storage; demo-4-3's and
+    // demo-4-4's Employees take names by value and move them into Person
+    vector<unit4_1::Customer> people1(RECORDS);
+    vector<unit4_3::Employee> people3(RECORDS);
+    vector<unit4_4::Employee> people4(RECORDS);
+    size_t moved1, copied1, moved3, copied3, moved4, copied4;
+    personSetterAllocations(people1, base, moved1, copied1);
+    personSetterAllocations(people3, base, moved3, copied3, 7, 42.50);
+    personSetterAllocations(people4, base, moved4, copied4, 12, 55.75);
+    size_t personReads = nameReadAllocations(people1, total) + nameReadAllocations(people3, total) +
+                         nameReadAllocations(people4, total);
+
+    cout << "setName(rvalue): " << tempCost << " allocation(s), "
+         << "setName(lvalue): " << lvalueCost << " allocation(s)" << endl;
+    cout << "by-value getter,  " << RECORDS << " reads: " << oldReads << " allocations" << endl;
+    cout << "const& getters, " << 2 * RECORDS << " reads: " << newReads
+         << " allocations" << endl;
+    cout << "Unit-4 setFields(rvalues): " << moved1 << " / " << moved3 << " / " << moved4
+         << " allocation(s), setFields(lvalues): " << copied1 << " / " << copied3 << " / " << copied4
+         << " (demo-4-1 / 4-3 / 4-4)" << endl;
+    cout << "Unit-4 const& getters, " << 6 * RECORDS << " reads: " << personReads << " allocations" << endl;
+    cout << "(checksum " << total << ")" << endl;
+
+    if (newReads != 0 || tempCost != 0 || lvalueCost > 1 || personReads != 0 || moved1 != 0 ||
+        copied1 != 0 || moved3 != 0 || copied3 > 2 || moved4 != 0 || copied4 > 2) {
+        cout << "FAIL: an accessor allocated" << endl;
+        return 1;
+    }
+    cout << "PASS" << endl;
+    return 0;
+}
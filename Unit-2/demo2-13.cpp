@@ -0,0 +1,214 @@
+// carpet_pricer.cpp
+// Batch pricing for demo2-2's Carpet.
+//  - PriceTiers: the area thresholds and prices, loaded from configuration
+//    instead of being local consts inside Carpet::setPrice()
+//  - CarpetPricer: prices whole arrays of rooms; the tier is picked without
+//    branches (count how many thresholds the area exceeds, then look the
+//    price up), 8 rooms per step with AVX2
+//  - Carpet: reprices lazily, once after any number of setter calls
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <charconv>
+#include <system_error>
+#include <random>
+#include <chrono>
+#include <cstddef>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_KERNELS 1
+#endif
+using namespace std;
+
+class PriceTiers {
+private:
+    vector<int> maxArea;     // ascending upper bounds, one per bounded tier
+    vector<double> price;    // maxArea.size() + 1 prices; the last is unbounded
+public:
+    // demo2-2's tiers: up to 12 sq ft, up to 24 sq ft, anything larger
+    PriceTiers() : maxArea{ 12, 24 }, price{ 29.99, 59.99, 89.99 } {}
+
+    // Reads lines of "<maxArea> <price>" with ascending areas, ending with
+    // "* <price>" for every larger area. Returns false on a bad config.
+    bool load(istream& in) {
+        vector<int> areas;
+        vector<double> prices;
+        string area;
+        double p;
+        while (in >> area >> p) {
+            prices.push_back(p);
+            if (area == "*") break;
+            int a;
+            auto parsed = from_chars(area.data(), area.data() + area.size(), a);
+            if (parsed.ec != errc() || parsed.ptr != area.data() + area.size()) return false;
+            if (!areas.empty() && a <= areas.back()) return false;
+            areas.push_back(a);
+        }
+        if (area != "*" || prices.size() != areas.size() + 1) return false;
+        maxArea.swap(areas);
+        price.swap(prices);
+        return true;
+    }
+
+    size_t tiers() const { return price.size(); }
+    const int* limits() const { return maxArea.data(); }
+    const double* prices() const { return price.data(); }
+
+    // tier = number of thresholds the area is above; no branches
+    double priceFor(int area) const {
+        size_t tier = 0;
+        for (int limit : maxArea) tier += area > limit;
+        return price[tier];
+    }
+};
+
+class CarpetPricer {
+private:
+    const PriceTiers& tiers;
+    bool simdAvailable;
+    bool useSimd;
+#ifdef HAVE_X86_KERNELS
+    void priceAvx2(const int* len, const int* wid, size_t n, int* area, double* out) const;
+#endif
+public:
+    explicit CarpetPricer(const PriceTiers& t) : tiers(t) {
+#ifdef HAVE_X86_KERNELS
+        simdAvailable = __builtin_cpu_supports("avx2");
+#else
+        simdAvailable = false;
+#endif
+        useSimd = simdAvailable;
+    }
+    // force the portable loop (used by the benchmark)
+    void setUseSimd(bool on) { useSimd = on && simdAvailable; }
+    bool getUseSimd() const { return useSimd; }
+
+    // area[i] = len[i] * wid[i], price[i] = tier price for that area
+    void price(const int* len, const int* wid, size_t n, int* area, double* out) const {
+#ifdef HAVE_X86_KERNELS
+        if (useSimd) return priceAvx2(len, wid, n, area, out);
+#endif
+        for (size_t x = 0; x < n; ++x) {
+            area[x] = len[x] * wid[x];
+            out[x] = tiers.priceFor(area[x]);
+        }
+    }
+};
+
+#ifdef HAVE_X86_KERNELS
+__attribute__((target("avx2")))
+void CarpetPricer::priceAvx2(const int* len, const int* wid, size_t n,
+                             int* area, double* out) const {
+    const size_t numLimits = tiers.tiers() - 1;
+    const int* limits = tiers.limits();
+    const double* prices = tiers.prices();
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));   // gather every lane
+    size_t x = 0;
+    for (; x + 8 <= n; x += 8) {
+        __m256i a = _mm256_mullo_epi32(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(len + x)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(wid + x)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(area + x), a);
+        // each exceeded threshold gives a -1 lane; subtracting counts them
+        __m256i tier = _mm256_setzero_si256();
+        for (size_t t = 0; t < numLimits; ++t)
+            tier = _mm256_sub_epi32(tier, _mm256_cmpgt_epi32(a, _mm256_set1_epi32(limits[t])));
+        _mm256_storeu_pd(out + x, _mm256_mask_i32gather_pd(
+            zero, prices, _mm256_castsi256_si128(tier), all, 8));
+        _mm256_storeu_pd(out + x + 4, _mm256_mask_i32gather_pd(
+            zero, prices, _mm256_extracti128_si256(tier, 1), all, 8));
+    }
+    for (; x < n; ++x) {
+        area[x] = len[x] * wid[x];
+        out[x] = tiers.priceFor(area[x]);
+    }
+}
+#endif
+
+class Carpet {
+private:
+    int length{};    // in feet
+    int width{};     // in feet
+    const PriceTiers* tiers;
+    mutable double price{};
+    mutable bool priceStale{true};   // set by the setters, cleared by getPrice()
+    // private helper, now only run when a price is actually read
+    void setPrice() const {
+        price = tiers->priceFor(length * width);
+        priceStale = false;
+    }
+public:
+    explicit Carpet(const PriceTiers& t) : tiers(&t) {}
+    void setLength(int len) { length = len; priceStale = true; }
+    void setWidth(int wid)  { width  = wid; priceStale = true; }
+    void setSize(int len, int wid) { length = len; width = wid; priceStale = true; }
+    int getLength() const { return length; }
+    int getWidth()  const { return width; }
+    double getPrice() const {
+        if (priceStale) setPrice();
+        return price;
+    }
+};
+
+// demo2-2's original if/else chain, for the benchmark
+double chainPrice(int area) {
+    const int SMALL = 12, MED = 24;
+    const double PRICE1 = 29.99, PRICE2 = 59.99, PRICE3 = 89.99;
+    if (area <= SMALL) return PRICE1;
+    else if (area <= MED) return PRICE2;
+    else return PRICE3;
+}
+
+double seconds(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    PriceTiers tiers;
+    istringstream config("12 29.99\n24 59.99\n48 89.99\n* 119.99\n");
+    if (!tiers.load(config)) {
+        cout << "Bad tier configuration" << endl;
+        return 1;
+    }
+
+    Carpet c(tiers);
+    c.setLength(3);
+    c.setWidth(5);   // no repricing yet: that happens once, in getPrice()
+    cout << "Area: " << c.getLength()*c.getWidth()
+         << "  Price: " << c.getPrice() << "\n";
+
+    // ---- 10^7 rooms, 1 to 10 feet per side ----
+    const size_t ROOMS = 10000000;
+    mt19937 rng(2);
+    uniform_int_distribution<int> side(1, 10);
+    vector<int> len(ROOMS), wid(ROOMS), area(ROOMS);
+    vector<double> price(ROOMS), check(ROOMS);
+    for (size_t x = 0; x < ROOMS; ++x) {
+        len[x] = side(rng);
+        wid[x] = side(rng);
+    }
+
+    PriceTiers demoTiers;   // demo2-2's three tiers, so all three agree
+    cout << fixed << setprecision(1);
+    auto t = chrono::steady_clock::now();
+    for (size_t x = 0; x < ROOMS; ++x) check[x] = chainPrice(len[x] * wid[x]);
+    cout << "if/else chain:     " << ROOMS / seconds(t) / 1e6 << " M rooms/s" << endl;
+
+    CarpetPricer pricer(demoTiers);
+    for (bool simd : { false, true }) {
+        pricer.setUseSimd(simd);
+        if (simd && !pricer.getUseSimd()) break;
+        fill(price.begin(), price.end(), 0.0);
+        t = chrono::steady_clock::now();
+        pricer.price(len.data(), wid.data(), ROOMS, area.data(), price.data());
+        double s = seconds(t);
+        cout << (simd ? "branchless avx2:   " : "branchless scalar: ")
+             << ROOMS / s / 1e6 << " M rooms/s"
+             << (price == check ? "" : "  MISMATCH") << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,227 @@
+// customer_ledger.cpp
+// Thread-safe balances for demo2-3's Customer model.
+// Balances are kept as int64 cents (no floating-point drift) and split
+// over 256 shards, each with its own lock on its own cache line, so
+// threads posting to different customers almost never contend.
+// A snapshot locks every shard in order, which gives a consistent view:
+// no posting or transfer is ever half-visible in it.
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+using namespace std;
+
+class CustomerLedger {
+public:
+    struct Snapshot {
+        vector<int64_t> cents;   // indexed by customer ID
+        int64_t totalCents{};
+    };
+
+    // Opens an account (or returns the existing one) for a customer name
+    int openAccount(const string& name, int64_t openingCents = 0);
+    bool findAccount(const string& name, int& id) const;
+    size_t size() const { return nextId.load(memory_order_acquire); }
+
+    // Postings return false, changing nothing, for an id that was never
+    // opened or a negative amount
+    bool credit(int id, int64_t cents);
+    // Also false, leaving the balance alone, if it would go below zero
+    bool debit(int id, int64_t cents);
+    // Moves cents between two accounts atomically; false on overdraft
+    bool transfer(int from, int to, int64_t cents);
+    // Throws out_of_range for an id that was never opened
+    int64_t balance(int id) const;
+    Snapshot snapshot() const;
+
+    static int64_t toCents(double dollars) { return llround(dollars * 100.0); }
+
+private:
+    static const int SHARDS = 256;
+    struct alignas(64) Shard {           // one cache line each: no false sharing
+        mutable mutex lock;
+        vector<int64_t> cents;           // customer id / SHARDS -> balance
+    };
+    Shard shards[SHARDS];
+    atomic<int> nextId{0};
+
+    mutable mutex nameLock;              // only taken when opening / finding by name
+    unordered_map<string, int> ids;
+
+    bool isOpen(int id) const { return id >= 0 && size_t(id) < size(); }
+    static Shard& shardOf(Shard* s, int id) { return s[id % SHARDS]; }
+    static size_t slotOf(int id) { return size_t(id / SHARDS); }
+};
+
+int CustomerLedger::openAccount(const string& name, int64_t openingCents) {
+    lock_guard<mutex> guard(nameLock);
+    auto it = ids.find(name);
+    if (it != ids.end()) return it->second;
+    int id = nextId.load(memory_order_relaxed);
+    Shard& sh = shardOf(shards, id);
+    {
+        lock_guard<mutex> g(sh.lock);
+        if (sh.cents.size() <= slotOf(id)) sh.cents.resize(slotOf(id) + 1, 0);
+        sh.cents[slotOf(id)] = openingCents;
+    }
+    ids.emplace(name, id);
+    nextId.store(id + 1, memory_order_release);
+    return id;
+}
+
+bool CustomerLedger::findAccount(const string& name, int& id) const {
+    lock_guard<mutex> guard(nameLock);
+    auto it = ids.find(name);
+    if (it == ids.end()) return false;
+    id = it->second;
+    return true;
+}
+
+bool CustomerLedger::credit(int id, int64_t cents) {
+    if (!isOpen(id) || cents < 0) return false;
+    Shard& sh = shardOf(shards, id);
+    lock_guard<mutex> guard(sh.lock);
+    sh.cents[slotOf(id)] += cents;
+    return true;
+}
+
+bool CustomerLedger::debit(int id, int64_t cents) {
+    if (!isOpen(id) || cents < 0) return false;
+    Shard& sh = shardOf(shards, id);
+    lock_guard<mutex> guard(sh.lock);
+    int64_t& bal = sh.cents[slotOf(id)];
+    if (bal < cents) return false;
+    bal -= cents;
+    return true;
+}
+
+bool CustomerLedger::transfer(int from, int to, int64_t cents) {
+    if (!isOpen(from) || !isOpen(to) || cents < 0) return false;
+    Shard& a = shardOf(shards, from);
+    Shard& b = shardOf(shards, to);
+    if (&a == &b) {
+        lock_guard<mutex> guard(a.lock);
+        if (a.cents[slotOf(from)] < cents) return false;
+        a.cents[slotOf(from)] -= cents;
+        a.cents[slotOf(to)] += cents;
+        return true;
+    }
+    // always lock the lower shard first so two transfers cannot deadlock
+    Shard& first = &a < &b ? a : b;
+    Shard& second = &a < &b ? b : a;
+    lock_guard<mutex> g1(first.lock);
+    lock_guard<mutex> g2(second.lock);
+    if (a.cents[slotOf(from)] < cents) return false;
+    a.cents[slotOf(from)] -= cents;
+    b.cents[slotOf(to)] += cents;
+    return true;
+}
+
+int64_t CustomerLedger::balance(int id) const {
+    if (!isOpen(id)) throw out_of_range("no such account");
+    const Shard& sh = shards[id % SHARDS];
+    lock_guard<mutex> guard(sh.lock);
+    return sh.cents[slotOf(id)];
+}
+
+CustomerLedger::Snapshot CustomerLedger::snapshot() const {
+    // holding every shard at once freezes one consistent cut of the ledger
+    for (const Shard& sh : shards) sh.lock.lock();
+    Snapshot snap;
+    snap.cents.resize(size());
+    for (size_t id = 0; id < snap.cents.size(); ++id) {
+        snap.cents[id] = shards[id % SHARDS].cents[slotOf(int(id))];
+        snap.totalCents += snap.cents[id];
+    }
+    for (const Shard& sh : shards) sh.lock.unlock();
+    return snap;
+}
+
+// a ledger behind one global lock, for comparison
+class GlobalLockLedger {
+private:
+    mutex lock;
+    vector<int64_t> cents;
+public:
+    explicit GlobalLockLedger(size_t n) : cents(n, 0) {}
+    bool transfer(int from, int to, int64_t c) {
+        lock_guard<mutex> guard(lock);
+        if (cents[from] < c) return false;
+        cents[from] -= c;
+        cents[to] += c;
+        return true;
+    }
+    void credit(int id, int64_t c) {
+        lock_guard<mutex> guard(lock);
+        cents[id] += c;
+    }
+};
+
+template <typename Ledger>
+double postingsPerSecond(Ledger& ledger, int threads, int customers, int opsPerThread) {
+    vector<thread> workers;
+    auto t = chrono::steady_clock::now();
+    for (int w = 0; w < threads; ++w)
+        workers.emplace_back([&, w] {
+            mt19937 rng(unsigned(w) + 1);
+            uniform_int_distribution<int> who(0, customers - 1);
+            for (int op = 0; op < opsPerThread; ++op) {
+                if (op % 4 == 0) ledger.credit(who(rng), 500);
+                else ledger.transfer(who(rng), who(rng), 125);
+            }
+        });
+    for (thread& th : workers) th.join();
+    double s = chrono::duration<double>(chrono::steady_clock::now() - t).count();
+    return double(threads) * opsPerThread / s;
+}
+
+int main() {
+    CustomerLedger ledger;
+    int aisha = ledger.openAccount("Aisha", CustomerLedger::toCents(120.50));
+    int ben = ledger.openAccount("Ben");
+    ledger.transfer(aisha, ben, CustomerLedger::toCents(20.25));
+    if (!ledger.debit(ben, CustomerLedger::toCents(50.00)))
+        cout << "Ben's $50.00 debit was declined" << endl;
+    if (!ledger.debit(ben, -CustomerLedger::toCents(50.00)) && !ledger.credit(999, 100))
+        cout << "A negative debit and a credit to unknown account #999 were rejected" << endl;
+    cout << fixed << setprecision(2);
+    cout << "Aisha has $" << ledger.balance(aisha) / 100.0 << ", Ben has $"
+         << ledger.balance(ben) / 100.0 << "\n";
+
+    // ---- scaling: 10^5 customers, 3 transfers per credit ----
+    const int CUSTOMERS = 100000;
+    const int TOTAL_OPS = 4000000;
+    CustomerLedger big;
+    for (int c = 0; c < CUSTOMERS; ++c) big.openAccount("C" + to_string(c), 10000);
+
+    // with fewer cores than threads the global lock rarely contends; the
+    // shards pay off once threads actually run side by side
+    cout << endl << setprecision(1) << thread::hardware_concurrency() << " hardware threads" << endl;
+    cout << "threads   sharded M ops/s   global-lock M ops/s" << endl;
+    int64_t credited = 0;
+    for (int threads = 1; threads <= 64; threads *= 2) {
+        int perThread = TOTAL_OPS / threads;
+        double sharded = postingsPerSecond(big, threads, CUSTOMERS, perThread);
+        credited += int64_t(threads) * ((perThread + 3) / 4) * 500;
+        GlobalLockLedger global(CUSTOMERS);
+        double single = postingsPerSecond(global, threads, CUSTOMERS, perThread);
+        cout << setw(7) << threads << setw(18) << sharded / 1e6
+             << setw(22) << single / 1e6 << endl;
+    }
+
+    // transfers move money around but never create it: the snapshot must add up
+    CustomerLedger::Snapshot snap = big.snapshot();
+    int64_t expected = int64_t(CUSTOMERS) * 10000 + credited;
+    cout << "snapshot total $" << snap.totalCents / 100.0 << " (expected $"
+         << expected / 100.0 << ")" << (snap.totalCents == expected ? "" : "  MISMATCH") << endl;
+    return 0;
+}
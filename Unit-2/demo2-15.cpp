@@ -0,0 +1,253 @@
+// fee_schedule_rcu.cpp
+// Replaces demo2-4's single `static double Student::athleticFee` with a
+// versioned FeeSchedule: fees per student category and per term that can
+// change while the program runs.
+//
+// Readers never lock and never do a contended read-modify-write. Each
+// reader thread owns a slot on its own cache line, and announces which
+// epoch it is reading in before loading the current table pointer.
+// A writer builds a new immutable table, swaps the pointer, advances the
+// epoch, and frees the old table only after every reader that could
+// still see it has left (RCU-style grace period).
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <chrono>
+#include <stdexcept>
+#include <cstdint>
+using namespace std;
+
+enum Category { FRESHMAN, SOPHOMORE, JUNIOR, SENIOR, NUM_CATEGORIES };
+
+// An immutable fee table: never changed once published
+struct FeeTable {
+    uint64_t version{};
+    int terms{};
+    vector<double> fees;   // category * terms + term
+    FeeTable(int t, double fee) : terms(t), fees(size_t(NUM_CATEGORIES) * t, fee) {}
+    double fee(Category c, int term) const { return fees[size_t(c) * terms + term]; }
+    void setFee(Category c, int term, double f) { fees[size_t(c) * terms + term] = f; }
+};
+
+class FeeSchedule {
+private:
+    static const int MAX_READERS = 256;
+    struct alignas(64) Slot {
+        atomic<bool> claimed{false};
+        atomic<uint64_t> activeEpoch{0};   // 0 = not inside a read
+    };
+    Slot slots[MAX_READERS];
+    atomic<const FeeTable*> current;
+    atomic<uint64_t> epoch{1};
+    mutex writerLock;                      // writers are serialized; readers never take it
+public:
+    explicit FeeSchedule(const FeeTable& initial) : current(new FeeTable(initial)) {}
+    ~FeeSchedule() { delete current.load(); }
+    FeeSchedule(const FeeSchedule&) = delete;
+    FeeSchedule& operator=(const FeeSchedule&) = delete;
+
+    // One per reading thread; holds one slot until destroyed
+    class Reader {
+    private:
+        FeeSchedule& schedule;
+        Slot* slot;
+    public:
+        explicit Reader(FeeSchedule& s) : schedule(s), slot(s.claimSlot()) {}
+        ~Reader() { slot->claimed.store(false, memory_order_release); }
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        // Calls f(const FeeTable&) on one consistent version of the table
+        template <typename F>
+        auto read(F f) {
+            // seq_cst keeps epoch load, announcement and pointer load in
+            // order; the slot is only written by this thread, so nothing contends
+            slot->activeEpoch.store(schedule.epoch.load());
+            // leaves the read even if f throws, or publish() would wait forever
+            struct Leave {
+                Slot* slot;
+                ~Leave() { slot->activeEpoch.store(0, memory_order_release); }
+            } leave{ slot };
+            const FeeTable* t = schedule.current.load();
+            return f(*t);
+        }
+        double fee(Category c, int term) {
+            return read([&](const FeeTable& t) { return t.fee(c, term); });
+        }
+    };
+
+    // Publishes a new table; returns its version. Blocks only the writer.
+    uint64_t publish(FeeTable next) {
+        lock_guard<mutex> guard(writerLock);
+        return publishLocked(std::move(next));
+    }
+
+    // Copies the current table, lets edit(FeeTable&) change the copy and
+    // publishes it, all under the writer lock, so concurrent updates never
+    // overwrite each other. Returns the new version.
+    template <typename F>
+    uint64_t update(F edit) {
+        lock_guard<mutex> guard(writerLock);
+        FeeTable next = *current.load();   // only a writer frees tables, and we hold the lock
+        edit(next);
+        return publishLocked(std::move(next));
+    }
+
+    // A private copy of the current table. Editing it and calling publish()
+    // is not atomic: if two writers do that at once, one of their changes
+    // is lost. Use update() to change a table in place.
+    FeeTable copyCurrent() {
+        Reader r(*this);
+        return r.read([](const FeeTable& t) { return t; });
+    }
+
+private:
+    uint64_t publishLocked(FeeTable next) {
+        next.version = current.load()->version + 1;
+        const FeeTable* old = current.exchange(new FeeTable(std::move(next)));
+        uint64_t newEpoch = epoch.fetch_add(1) + 1;
+        // grace period: wait out readers that entered before the swap
+        for (Slot& s : slots) {
+            if (!s.claimed.load(memory_order_acquire)) continue;
+            for (;;) {
+                uint64_t e = s.activeEpoch.load();
+                if (e == 0 || e >= newEpoch) break;
+                this_thread::yield();
+            }
+        }
+        uint64_t v = current.load()->version;
+        delete old;
+        return v;
+    }
+
+    Slot* claimSlot() {
+        for (Slot& s : slots) {
+            bool expected = false;
+            if (s.claimed.compare_exchange_strong(expected, true)) return &s;
+        }
+        throw runtime_error("too many FeeSchedule readers");
+    }
+};
+
+// demo2-4's Student, now asking the schedule for its fee
+class Student {
+private:
+    int idNum{};
+    Category category{FRESHMAN};
+public:
+    void setId(int id) { idNum = id; }
+    void setCategory(Category c) { category = c; }
+    int getId() const { return idNum; }
+    double getAthleticFee(FeeSchedule::Reader& fees, int term) const {
+        return fees.fee(category, term);
+    }
+};
+
+// the same table behind a reader/writer lock, for comparison
+class LockedFees {
+private:
+    mutable shared_mutex lock;
+    FeeTable table;
+public:
+    explicit LockedFees(const FeeTable& t) : table(t) {}
+    double fee(Category c, int term) const {
+        shared_lock<shared_mutex> guard(lock);
+        return table.fee(c, term);
+    }
+    void publish(const FeeTable& t) {
+        unique_lock<shared_mutex> guard(lock);
+        table = t;
+    }
+};
+
+const int TERMS = 3;
+const chrono::milliseconds RUN_TIME(200);
+
+// reads/second across all reader threads while a writer publishes every ms
+double rcuReads(FeeSchedule& schedule, int readers) {
+    atomic<bool> stop{false};
+    atomic<uint64_t> total{0};
+    vector<thread> threads;
+    for (int r = 0; r < readers; ++r)
+        threads.emplace_back([&, r] {
+            FeeSchedule::Reader fees(schedule);
+            uint64_t n = 0;
+            double sum = 0;
+            while (!stop.load(memory_order_relaxed))
+                for (int k = 0; k < 1000; ++k, ++n)
+                    sum += fees.fee(Category((n + r) % NUM_CATEGORIES), int(n % TERMS));
+            total += n + (sum < 0);
+        });
+    thread writer([&] {
+        while (!stop.load()) {
+            schedule.update([](FeeTable& t) { t.setFee(SENIOR, 0, t.fee(SENIOR, 0) + 0.01); });
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+    });
+    this_thread::sleep_for(RUN_TIME);
+    stop = true;
+    for (thread& t : threads) t.join();
+    writer.join();
+    return double(total) / chrono::duration<double>(RUN_TIME).count();
+}
+
+double lockedReads(LockedFees& fees, int readers) {
+    atomic<bool> stop{false};
+    atomic<uint64_t> total{0};
+    vector<thread> threads;
+    for (int r = 0; r < readers; ++r)
+        threads.emplace_back([&, r] {
+            uint64_t n = 0;
+            double sum = 0;
+            while (!stop.load(memory_order_relaxed))
+                for (int k = 0; k < 1000; ++k, ++n)
+                    sum += fees.fee(Category((n + r) % NUM_CATEGORIES), int(n % TERMS));
+            total += n + (sum < 0);
+        });
+    thread writer([&] {
+        FeeTable next(TERMS, 45.25);
+        while (!stop.load()) {
+            fees.publish(next);
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+    });
+    this_thread::sleep_for(RUN_TIME);
+    stop = true;
+    for (thread& t : threads) t.join();
+    writer.join();
+    return double(total) / chrono::duration<double>(RUN_TIME).count();
+}
+
+int main() {
+    FeeSchedule schedule(FeeTable(TERMS, 45.25));   // demo2-4's fee everywhere
+    FeeSchedule::Reader fees(schedule);
+
+    Student a, b;
+    a.setId(1234); b.setId(2345);
+    b.setCategory(SOPHOMORE);
+    cout << "Freshman: " << a.getId() << " Fee: " << a.getAthleticFee(fees, 0) << "\n";
+
+    uint64_t v = schedule.update([](FeeTable& t) { t.setFee(SOPHOMORE, 0, 50.00); });
+    cout << "Sophomore: " << b.getId() << " Fee: " << b.getAthleticFee(fees, 0)
+         << " (schedule version " << v << ")\n";
+
+    try {
+        fees.read([](const FeeTable&) -> double { throw runtime_error("reader failed"); });
+    } catch (const runtime_error&) {
+        cout << "A reader threw; publishing still works: version "
+             << schedule.update([](FeeTable& t) { t.setFee(JUNIOR, 1, 47.00); }) << "\n";
+    }
+
+    cout << endl << fixed << setprecision(1)
+         << "readers   rcu M reads/s   shared_mutex M reads/s   ("
+         << thread::hardware_concurrency() << " hardware threads)" << endl;
+    LockedFees locked(FeeTable(TERMS, 45.25));
+    for (int readers = 1; readers <= 16; readers *= 2)
+        cout << setw(7) << readers << setw(16) << rcuReads(schedule, readers) / 1e6
+             << setw(25) << lockedReads(locked, readers) / 1e6 << endl;
+    return 0;
+}
@@ -0,0 +1,213 @@
+// account_batches.cpp
+// demo2-5's fluent Account::deposit(...).withdraw(...) chain, recorded as
+// a Batch and committed with ONE atomic update instead of one per call.
+//  - a Batch only keeps two numbers while it records: the net change and
+//    the lowest running total, so recording costs no allocation
+//  - commit() is a single compare-and-swap on the balance; it rejects the
+//    whole batch if any step of it would take the balance below zero
+//  - a PostingPool applies many batches for many accounts on worker threads
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+using namespace std;
+
+class Account {
+private:
+    atomic<int64_t> balance{0};   // in cents
+public:
+    class Batch {
+    private:
+        Account* account;
+        int64_t net{};        // sum of all operations
+        int64_t lowest{};     // lowest running total, relative to the start
+        int ops{};
+        void add(int64_t cents) {
+            net += cents;
+            lowest = net < lowest ? net : lowest;
+            ++ops;
+        }
+    public:
+        explicit Batch(Account& a) : account(&a) {}
+        Batch& deposit(double amt) { add(llround(amt * 100.0)); return *this; }
+        Batch& withdraw(double amt) { add(-llround(amt * 100.0)); return *this; }
+        int size() const { return ops; }
+        // Applies every operation at once, or none if one would overdraw
+        bool commit() const { return account->apply(net, lowest); }
+    };
+
+    Batch batch() { return Batch(*this); }
+
+    // immediate, one atomic add per call (the demo2-5 behaviour)
+    Account& deposit(double amt) {
+        balance.fetch_add(llround(amt * 100.0));
+        return *this;
+    }
+    Account& withdraw(double amt) {
+        balance.fetch_sub(llround(amt * 100.0));
+        return *this;
+    }
+    double getBalance() const { return balance.load() / 100.0; }
+    int64_t getCents() const { return balance.load(); }
+
+private:
+    bool apply(int64_t net, int64_t lowest) {
+        int64_t cur = balance.load(memory_order_relaxed);
+        do {
+            if (cur + lowest < 0) return false;   // some step would overdraw
+        } while (!balance.compare_exchange_weak(cur, cur + net, memory_order_acq_rel,
+                                                memory_order_relaxed));
+        return true;
+    }
+};
+
+// Fixed set of worker threads applying batches in chunks
+class PostingPool {
+private:
+    vector<thread> workers;
+    mutex lock;
+    condition_variable wake, done;
+    const vector<Account::Batch>* work{nullptr};
+    size_t next{}, finished{}, chunk{};
+    atomic<size_t> committed{0};
+    bool stopping{false};
+    uint64_t generation{};
+
+    void run() {
+        uint64_t seen = 0;
+        for (;;) {
+            unique_lock<mutex> guard(lock);
+            wake.wait(guard, [&] { return stopping || (work && generation != seen && next < work->size()); });
+            if (stopping) return;
+            size_t begin = next;
+            size_t end = min(work->size(), begin + chunk);
+            next = end;
+            if (next >= work->size()) seen = generation;   // nothing left to claim
+            const vector<Account::Batch>& batches = *work;
+            guard.unlock();
+
+            size_t ok = 0;
+            for (size_t x = begin; x < end; ++x) ok += batches[x].commit();
+            committed += ok;
+
+            guard.lock();
+            finished += end - begin;
+            if (finished == work->size()) done.notify_all();
+        }
+    }
+public:
+    explicit PostingPool(unsigned threads) {
+        for (unsigned t = 0; t < threads; ++t) workers.emplace_back(&PostingPool::run, this);
+    }
+    ~PostingPool() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (thread& t : workers) t.join();
+    }
+
+    // Commits every batch; returns how many were accepted
+    size_t apply(const vector<Account::Batch>& batches, size_t chunkSize = 4096) {
+        unique_lock<mutex> guard(lock);
+        work = &batches;
+        next = finished = 0;
+        chunk = chunkSize;
+        committed = 0;
+        ++generation;
+        wake.notify_all();
+        done.wait(guard, [&] { return finished == batches.size(); });
+        work = nullptr;
+        return committed;
+    }
+};
+
+// the same operations made thread-safe one call at a time, for comparison
+class LockedAccount {
+private:
+    mutex lock;
+    int64_t balance{};
+public:
+    LockedAccount& deposit(int64_t c) { lock_guard<mutex> g(lock); balance += c; return *this; }
+    LockedAccount& withdraw(int64_t c) {
+        lock_guard<mutex> g(lock);
+        if (balance >= c) balance -= c;
+        return *this;
+    }
+};
+
+double seconds(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    Account acc;
+    bool ok = acc.batch().deposit(100).withdraw(30).deposit(10).commit();
+    cout << "Balance: " << acc.getBalance() << (ok ? "" : " (batch rejected)") << "\n";
+    ok = acc.batch().withdraw(90).deposit(500).commit();   // dips below zero midway
+    cout << "Balance: " << acc.getBalance() << (ok ? "" : " (batch rejected)") << "\n";
+
+    // ---- 10^6 batches of 10 operations over 10^4 accounts ----
+    const int ACCOUNTS = 10000, BATCHES = 1000000, OPS = 10;
+    vector<Account> accounts(ACCOUNTS);
+    vector<LockedAccount> locked(ACCOUNTS);
+    mt19937 rng(5);
+    uniform_int_distribution<int> who(0, ACCOUNTS - 1), cents(1, 5000);
+    vector<int> target(BATCHES);
+    vector<int64_t> amounts(size_t(BATCHES) * OPS);
+    for (int b = 0; b < BATCHES; ++b) {
+        target[b] = who(rng);
+        for (int k = 0; k < OPS; ++k)
+            amounts[size_t(b) * OPS + k] = (k % 3 == 2 ? -1 : 1) * cents(rng);
+    }
+
+    unsigned threads = max(2u, thread::hardware_concurrency());
+    cout << fixed << setprecision(1) << endl;
+
+    // baseline: every operation takes the account's lock
+    auto t = chrono::steady_clock::now();
+    vector<thread> pool;
+    for (unsigned w = 0; w < threads; ++w)
+        pool.emplace_back([&, w] {
+            for (size_t b = w; b < size_t(BATCHES); b += threads)
+                for (int k = 0; k < OPS; ++k) {
+                    int64_t c = amounts[b * OPS + k];
+                    if (c > 0) locked[target[b]].deposit(c);
+                    else locked[target[b]].withdraw(-c);
+                }
+        });
+    for (thread& th : pool) th.join();
+    double lockedSec = seconds(t);
+
+    // timed from recording to commit, so the per-operation work is included
+    PostingPool posting(threads);
+    t = chrono::steady_clock::now();
+    vector<Account::Batch> batches;
+    batches.reserve(BATCHES);
+    for (int b = 0; b < BATCHES; ++b) {
+        Account::Batch batch = accounts[target[b]].batch();
+        for (int k = 0; k < OPS; ++k) {
+            int64_t c = amounts[size_t(b) * OPS + k];
+            if (c > 0) batch.deposit(c / 100.0);
+            else batch.withdraw(-c / 100.0);
+        }
+        batches.push_back(batch);
+    }
+    size_t committed = posting.apply(batches);
+    double batchSec = seconds(t);
+
+    double totalOps = double(BATCHES) * OPS;
+    cout << threads << " workers" << endl;
+    cout << "lock per operation: " << totalOps / lockedSec / 1e6 << " M ops/s" << endl;
+    cout << "one CAS per batch:  " << totalOps / batchSec / 1e6 << " M ops/s ("
+         << committed << " of " << BATCHES << " batches committed)" << endl;
+    return 0;
+}
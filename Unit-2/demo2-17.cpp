@@ -0,0 +1,250 @@
+// shape_set_columns.cpp
+// Data-oriented storage for demo2-6's shapes. Instead of one heap object
+// per shape behind a vector<unique_ptr<Shape>>, a ShapeSet keeps each
+// concrete type in its own struct-of-arrays columns. Every area here is
+// scale * x * y (w*h, pi*r*r, 0.5*base*height), so one SIMD kernel
+// serves all three; a circle stores r once and the kernel reads that
+// column as both x and y. A new shape whose area is not of this form
+// (a polygon, an ellipse ring) needs its own columns and kernel.
+// Code that wants to treat one shape at a time still can, through a
+// small ShapeHandle (type + index) instead of a pointer.
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_KERNELS 1
+#endif
+using namespace std;
+
+// ---------------- demo2-6's hierarchy (plus a Triangle) ----------------
+struct Shape {
+    virtual ~Shape() = default;
+    virtual double area() const = 0;
+};
+struct Rectangle : Shape {
+    double w, h;
+    Rectangle(double w, double h): w(w), h(h) {}
+    double area() const override { return w * h; }
+};
+struct Circle : Shape {
+    double r;
+    explicit Circle(double r): r(r) {}
+    double area() const override { return M_PI * r * r; }
+};
+struct Triangle : Shape {
+    double base, height;
+    Triangle(double b, double h): base(b), height(h) {}
+    double area() const override { return 0.5 * base * height; }
+};
+
+// ---------------- kernels: scale * x[i] * y[i] ----------------
+double sumScaledProducts(const double* x, const double* y, size_t n, double scale) {
+    double s = 0.0;
+    for (size_t i = 0; i < n; ++i) s += x[i] * y[i];
+    return s * scale;
+}
+void scaledProducts(const double* x, const double* y, size_t n, double scale, double* out) {
+    for (size_t i = 0; i < n; ++i) out[i] = scale * x[i] * y[i];
+}
+
+#ifdef HAVE_X86_KERNELS
+__attribute__((target("avx2,fma")))
+double sumScaledProductsAvx2(const double* x, const double* y, size_t n, double scale) {
+    // four accumulators keep four FMAs in flight
+    __m256d a0 = _mm256_setzero_pd(), a1 = a0, a2 = a0, a3 = a0;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        a0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), a0);
+        a1 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4), a1);
+        a2 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 8), _mm256_loadu_pd(y + i + 8), a2);
+        a3 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 12), _mm256_loadu_pd(y + i + 12), a3);
+    }
+    __m256d a = _mm256_add_pd(_mm256_add_pd(a0, a1), _mm256_add_pd(a2, a3));
+    __m128d h = _mm_add_pd(_mm256_castpd256_pd128(a), _mm256_extractf128_pd(a, 1));
+    double s = _mm_cvtsd_f64(_mm_add_sd(h, _mm_unpackhi_pd(h, h)));
+    for (; i < n; ++i) s += x[i] * y[i];
+    return s * scale;
+}
+
+__attribute__((target("avx2,fma")))
+void scaledProductsAvx2(const double* x, const double* y, size_t n, double scale, double* out) {
+    const __m256d k = _mm256_set1_pd(scale);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(out + i, _mm256_mul_pd(k, _mm256_mul_pd(_mm256_loadu_pd(x + i),
+                                                                  _mm256_loadu_pd(y + i))));
+    for (; i < n; ++i) out[i] = scale * x[i] * y[i];
+}
+#endif
+
+bool useAvx2() {
+#ifdef HAVE_X86_KERNELS
+    static const bool ok = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return ok;
+#else
+    return false;
+#endif
+}
+
+// ---------------- ShapeSet ----------------
+enum ShapeKind : uint8_t { RECTANGLE, CIRCLE, TRIANGLE, NUM_KINDS };
+
+struct ShapeHandle {
+    ShapeKind kind;
+    uint32_t index;   // row within that kind's columns
+};
+
+class ShapeSet {
+private:
+    // One block of columns per kind: area = scale * x * y. A kind
+    // with square = true keeps only x and uses it as y as well.
+    struct Columns {
+        double scale;
+        bool square;
+        vector<double> x, y;
+        size_t size() const { return x.size(); }
+        const double* ys() const { return square ? x.data() : y.data(); }
+    };
+    Columns cols[NUM_KINDS] = {
+        { 1.0, false, {}, {} },    // Rectangle: w, h
+        { M_PI, true, {}, {} },    // Circle: r
+        { 0.5, false, {}, {} },    // Triangle: base, height
+    };
+
+    ShapeHandle add(ShapeKind k, double x, double y) {
+        cols[k].x.push_back(x);
+        if (!cols[k].square) cols[k].y.push_back(y);
+        return ShapeHandle{ k, uint32_t(cols[k].size() - 1) };
+    }
+public:
+    ShapeHandle addRectangle(double w, double h) { return add(RECTANGLE, w, h); }
+    ShapeHandle addCircle(double r) { return add(CIRCLE, r, r); }
+    ShapeHandle addTriangle(double b, double h) { return add(TRIANGLE, b, h); }
+
+    size_t size(ShapeKind k) const { return cols[k].size(); }
+    size_t size() const {
+        size_t n = 0;
+        for (const Columns& c : cols) n += c.size();
+        return n;
+    }
+
+    // one shape at a time, for code that needs the polymorphic view
+    double area(ShapeHandle s) const {
+        const Columns& c = cols[s.kind];
+        return c.scale * c.x[s.index] * c.ys()[s.index];
+    }
+
+    double totalArea() const {
+        double total = 0.0;
+        for (const Columns& c : cols) {
+#ifdef HAVE_X86_KERNELS
+            if (useAvx2()) {
+                total += sumScaledProductsAvx2(c.x.data(), c.ys(), c.size(), c.scale);
+                continue;
+            }
+#endif
+            total += sumScaledProducts(c.x.data(), c.ys(), c.size(), c.scale);
+        }
+        return total;
+    }
+
+    // Writes every area, kind by kind; the area of handle s lands at
+    // out[offset(s.kind) + s.index]. out must hold size() values.
+    size_t offset(ShapeKind k) const {
+        size_t o = 0;
+        for (int j = 0; j < k; ++j) o += cols[j].size();
+        return o;
+    }
+    void areas(double* out) const {
+        for (const Columns& c : cols) {
+#ifdef HAVE_X86_KERNELS
+            if (useAvx2()) scaledProductsAvx2(c.x.data(), c.ys(), c.size(), c.scale, out);
+            else
+#endif
+            scaledProducts(c.x.data(), c.ys(), c.size(), c.scale, out);
+            out += c.size();
+        }
+    }
+};
+
+double seconds(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    ShapeSet set;
+    vector<ShapeHandle> v;
+    v.push_back(set.addRectangle(3, 4));
+    v.push_back(set.addCircle(2.0));
+    for (ShapeHandle s : v) cout << set.area(s) << "\n";   // same call, different shapes
+
+    // ---- 10^7 mixed shapes ----
+    const size_t N = 10000000;
+    mt19937 rng(6);
+    uniform_real_distribution<double> dim(0.5, 10.0);
+    uniform_int_distribution<int> kind(0, NUM_KINDS - 1);
+
+    auto t = chrono::steady_clock::now();
+    vector<unique_ptr<Shape>> objects;
+    objects.reserve(N);
+    ShapeSet shapes;
+    vector<ShapeHandle> handles;
+    handles.reserve(N);
+    for (size_t i = 0; i < N; ++i) {
+        double a = dim(rng), b = dim(rng);
+        switch (kind(rng)) {
+        case RECTANGLE:
+            objects.emplace_back(make_unique<Rectangle>(a, b));
+            handles.push_back(shapes.addRectangle(a, b));
+            break;
+        case CIRCLE:
+            objects.emplace_back(make_unique<Circle>(a));
+            handles.push_back(shapes.addCircle(a));
+            break;
+        default:
+            objects.emplace_back(make_unique<Triangle>(a, b));
+            handles.push_back(shapes.addTriangle(a, b));
+            break;
+        }
+    }
+    cout << fixed << setprecision(1) << endl << "built " << N << " shapes both ways in "
+         << seconds(t) << " s" << endl;
+
+    t = chrono::steady_clock::now();
+    double virtualTotal = 0.0;
+    for (auto& s : objects) virtualTotal += s->area();
+    double virtualSec = seconds(t);
+
+    t = chrono::steady_clock::now();
+    double handleTotal = 0.0;
+    for (ShapeHandle h : handles) handleTotal += shapes.area(h);
+    double handleSec = seconds(t);
+
+    t = chrono::steady_clock::now();
+    double bulkTotal = shapes.totalArea();
+    double bulkSec = seconds(t);
+
+    vector<double> out(shapes.size());
+    t = chrono::steady_clock::now();
+    shapes.areas(out.data());
+    double areasSec = seconds(t);
+
+    cout << setprecision(2);
+    cout << "virtual area() over unique_ptr: " << virtualSec * 1e3 << " ms  total "
+         << virtualTotal << endl;
+    cout << "ShapeHandle one at a time:      " << handleSec * 1e3 << " ms  total "
+         << handleTotal << endl;
+    cout << "ShapeSet::totalArea():          " << bulkSec * 1e3 << " ms  total "
+         << bulkTotal << endl;
+    cout << "ShapeSet::areas() into array:   " << areasSec * 1e3 << " ms" << endl;
+    cout << "relative difference: " << scientific << fabs(bulkTotal - virtualTotal) / virtualTotal
+         << " (summation order only)" << endl;
+    return 0;
+}
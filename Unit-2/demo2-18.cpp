@@ -0,0 +1,315 @@
+// shape_arena.cpp
+// demo2-6's polymorphic shapes, still called through virtual area(), but
+// allocated from an arena instead of one malloc per make_unique.
+//  - Arena: bump allocation out of large blocks; reset() runs every
+//    destructor in reverse order and rewinds, keeping the blocks for reuse
+//  - make_in_arena<T>(arena, args...) returns an ArenaPtr<T>, a move-only
+//    handle that converts to ArenaPtr<Base> like unique_ptr does; the arena,
+//    not the handle, destroys the object
+//  - PoolArena: one Arena per type, so objects of the same type sit next
+//    to each other
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <random>
+#include <chrono>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+using namespace std;
+
+class Arena {
+public:
+    explicit Arena(size_t blockSize = 64 * 1024) : blockSize(blockSize) {}
+    ~Arena() { reset(); }
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t size, size_t align) {
+        uintptr_t p = (uintptr_t(ptr) + align - 1) & ~uintptr_t(align - 1);
+        if (!ptr || p + size > uintptr_t(end)) {
+            nextBlock(size + align);
+            p = (uintptr_t(ptr) + align - 1) & ~uintptr_t(align - 1);
+        }
+        ptr = reinterpret_cast<char*>(p + size);
+        used += size;
+        return reinterpret_cast<void*>(p);
+    }
+
+    // Remembers obj so reset() destroys it
+    template <typename T>
+    void destroyOnReset(T* obj) {
+        dtors.push_back(Dtor{ [](void* o) { static_cast<T*>(o)->~T(); }, obj });
+    }
+
+    // Destroys every object (newest first) and rewinds to the first block.
+    // Handles from before the reset must not be used afterwards.
+    void reset() {
+        for (size_t i = dtors.size(); i-- > 0; ) dtors[i].fn(dtors[i].obj);
+        dtors.clear();
+        current = 0;
+        ptr = blocks.empty() ? nullptr : blocks[0].data.get();
+        end = blocks.empty() ? nullptr : ptr + blocks[0].size;
+        used = 0;
+        ++gen;
+    }
+
+    uint64_t generation() const { return gen; }
+    size_t bytesUsed() const { return used; }
+    size_t bytesReserved() const {
+        size_t n = 0;
+        for (const Block& b : blocks) n += b.size;
+        return n;
+    }
+
+private:
+    struct Block {
+        unique_ptr<char[]> data;
+        size_t size;
+    };
+    struct Dtor {
+        void (*fn)(void*);
+        void* obj;
+    };
+    size_t blockSize;
+    vector<Block> blocks;
+    size_t current{};
+    char* ptr{};
+    char* end{};
+    size_t used{};
+    vector<Dtor> dtors;
+    uint64_t gen{};
+
+    void nextBlock(size_t minSize) {
+        // reuse the next kept block if it is big enough, else add one here
+        size_t next = ptr ? current + 1 : current;
+        if (next >= blocks.size() || blocks[next].size < minSize) {
+            size_t size = max(blockSize, minSize);
+            blocks.insert(blocks.begin() + next, Block{ unique_ptr<char[]>(new char[size]), size });
+        }
+        current = next;
+        ptr = blocks[current].data.get();
+        end = ptr + blocks[current].size;
+    }
+};
+
+// Owning handle to an object in an Arena. Moving it moves the ownership;
+// dropping it does nothing, the object lives until the arena resets.
+// Debug builds also check that the arena has not been reset since.
+template <typename T>
+class ArenaPtr {
+private:
+    template <typename U> friend class ArenaPtr;
+    T* p{};
+#ifndef NDEBUG
+    const Arena* arena{};
+    uint64_t gen{};
+#endif
+public:
+    ArenaPtr() = default;
+    ArenaPtr(T* obj, const Arena& a) : p(obj) {
+#ifndef NDEBUG
+        arena = &a;
+        gen = a.generation();
+#else
+        (void)a;
+#endif
+    }
+    ArenaPtr(ArenaPtr&& o) noexcept { *this = std::move(o); }
+    template <typename U, typename = enable_if_t<is_convertible<U*, T*>::value>>
+    ArenaPtr(ArenaPtr<U>&& o) noexcept : p(o.p) {
+#ifndef NDEBUG
+        arena = o.arena;
+        gen = o.gen;
+#endif
+        o.p = nullptr;
+    }
+    ArenaPtr& operator=(ArenaPtr&& o) noexcept {
+        p = o.p;
+#ifndef NDEBUG
+        arena = o.arena;
+        gen = o.gen;
+#endif
+        o.p = nullptr;
+        return *this;
+    }
+    ArenaPtr(const ArenaPtr&) = delete;
+    ArenaPtr& operator=(const ArenaPtr&) = delete;
+
+    bool valid() const {
+#ifndef NDEBUG
+        return p && arena->generation() == gen;
+#else
+        return p != nullptr;
+#endif
+    }
+    T* get() const { assert(valid()); return p; }
+    T* operator->() const { return get(); }
+    T& operator*() const { return *get(); }
+};
+
+template <typename T, typename... Args>
+ArenaPtr<T> make_in_arena(Arena& arena, Args&&... args) {
+    void* mem = arena.allocate(sizeof(T), alignof(T));
+    T* obj = new (mem) T(std::forward<Args>(args)...);
+    if (!is_trivially_destructible<T>::value) arena.destroyOnReset(obj);
+    return ArenaPtr<T>(obj, arena);
+}
+
+// a small number per type, handed out on first use
+inline size_t nextTypeSlot() {
+    static atomic<size_t> next{0};
+    return next++;
+}
+template <typename T>
+size_t typeSlot() {
+    static const size_t slot = nextTypeSlot();
+    return slot;
+}
+
+// One Arena per type. reset() resets the pools one after the other, so
+// objects must not rely on being destroyed before objects of another type.
+class PoolArena {
+private:
+    size_t blockSize;
+    vector<unique_ptr<Arena>> pools;   // indexed by typeSlot<T>()
+public:
+    explicit PoolArena(size_t blockSize = 64 * 1024) : blockSize(blockSize) {}
+
+    template <typename T>
+    Arena& pool() {
+        size_t s = typeSlot<T>();
+        if (s >= pools.size()) pools.resize(s + 1);
+        if (!pools[s]) pools[s] = make_unique<Arena>(blockSize);
+        return *pools[s];
+    }
+    void reset() {
+        for (auto& a : pools)
+            if (a) a->reset();
+    }
+    size_t bytesReserved() const {
+        size_t n = 0;
+        for (auto& a : pools)
+            if (a) n += a->bytesReserved();
+        return n;
+    }
+};
+
+template <typename T, typename... Args>
+ArenaPtr<T> make_in_arena(PoolArena& arena, Args&&... args) {
+    return make_in_arena<T>(arena.pool<T>(), std::forward<Args>(args)...);
+}
+
+// ---------------- demo2-6's shapes ----------------
+struct Shape {
+    virtual ~Shape() = default;
+    virtual double area() const = 0; // pure virtual => polymorphic API
+};
+
+struct Rectangle : Shape {
+    double w, h;
+    Rectangle(double w, double h): w(w), h(h) {}
+    double area() const override { return w * h; }
+};
+
+struct Circle : Shape {
+    double r;
+    explicit Circle(double r): r(r) {}
+    double area() const override { return M_PI * r * r; }
+};
+
+double seconds(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// One "frame": build SHAPES shapes, add up their areas, drop them all.
+// make(isCircle, a, b) adds one shape to v; endFrame() frees them.
+template <typename Handle, typename Make, typename EndFrame>
+double runFrames(vector<Handle>& v, const vector<double>& dims, int frames,
+                 Make make, EndFrame endFrame, double& iterSec) {
+    double total = 0.0;
+    iterSec = 0.0;
+    for (int f = 0; f < frames; ++f) {
+        v.clear();
+        for (size_t i = 0; i + 1 < dims.size(); i += 2)
+            v.push_back(make((i / 2) % 3 == 1, dims[i], dims[i + 1]));
+        auto t = chrono::steady_clock::now();
+        for (auto& s : v) total += s->area();
+        iterSec += seconds(t);
+        v.clear();
+        endFrame();
+    }
+    return total;
+}
+
+int main() {
+    Arena arena;
+    vector<ArenaPtr<Shape>> v;
+    v.emplace_back(make_in_arena<Rectangle>(arena, 3, 4));
+    v.emplace_back(make_in_arena<Circle>(arena, 2.0));
+    for (auto& s : v) cout << s->area() << "\n"; // same call, different behavior
+    v.clear();
+    arena.reset();   // both shapes destroyed here
+
+    // ---- 20 frames of 10^6 shapes (two rectangles per circle) ----
+    const size_t SHAPES = 1000000;
+    const int FRAMES = 20;
+    mt19937 rng(7);
+    uniform_real_distribution<double> dim(0.5, 10.0);
+    vector<double> dims(2 * SHAPES);
+    for (double& d : dims) d = dim(rng);
+
+    cout << fixed << setprecision(1) << endl;
+    double iterSec;
+
+    vector<unique_ptr<Shape>> heap;
+    heap.reserve(SHAPES);
+    auto t = chrono::steady_clock::now();
+    double heapTotal = runFrames(heap, dims, FRAMES,
+        [](bool circle, double a, double b) -> unique_ptr<Shape> {
+            if (circle) return make_unique<Circle>(a);
+            return make_unique<Rectangle>(a, b);
+        },
+        [] {}, iterSec);
+    double heapSec = seconds(t);
+    cout << "make_unique:   " << heapSec * 1e9 / (double(SHAPES) * FRAMES) << " ns/shape, area loop "
+         << iterSec * 1e3 / FRAMES << " ms/frame" << endl;
+
+    Arena frameArena;
+    vector<ArenaPtr<Shape>> handles;
+    handles.reserve(SHAPES);
+    t = chrono::steady_clock::now();
+    double arenaTotal = runFrames(handles, dims, FRAMES,
+        [&](bool circle, double a, double b) -> ArenaPtr<Shape> {
+            if (circle) return make_in_arena<Circle>(frameArena, a);
+            return make_in_arena<Rectangle>(frameArena, a, b);
+        },
+        [&] { frameArena.reset(); }, iterSec);
+    double arenaSec = seconds(t);
+    cout << "Arena:         " << arenaSec * 1e9 / (double(SHAPES) * FRAMES) << " ns/shape, area loop "
+         << iterSec * 1e3 / FRAMES << " ms/frame, " << frameArena.bytesReserved() / 1024
+         << " KiB kept" << endl;
+
+    PoolArena pools;
+    t = chrono::steady_clock::now();
+    double poolTotal = runFrames(handles, dims, FRAMES,
+        [&](bool circle, double a, double b) -> ArenaPtr<Shape> {
+            if (circle) return make_in_arena<Circle>(pools, a);
+            return make_in_arena<Rectangle>(pools, a, b);
+        },
+        [&] { pools.reset(); }, iterSec);
+    double poolSec = seconds(t);
+    cout << "PoolArena:     " << poolSec * 1e9 / (double(SHAPES) * FRAMES) << " ns/shape, area loop "
+         << iterSec * 1e3 / FRAMES << " ms/frame, " << pools.bytesReserved() / 1024
+         << " KiB kept" << endl;
+
+    bool same = heapTotal == arenaTotal && heapTotal == poolTotal;
+    cout << "totals " << (same ? "match" : "DIFFER") << " (" << heapTotal << ")" << endl;
+    return 0;
+}
@@ -0,0 +1,314 @@
+// payroll_run.cpp
+// Payroll for millions of demo2-7 Employees in one pass.
+//  - EmployeeBatch: the employees as columns (id, department, rate, hours)
+//  - PayrollRun: gross pay with overtime tiers, per employee and per
+//    department, all in integer cents
+//  - WorkStealingPool: the batch is cut into cache-sized chunks; each
+//    worker starts on its own share and steals from the others when done
+// Every chunk writes its department totals to its own slot, and the slots
+// are added up in chunk order afterwards, so the totals are the same for
+// any thread count and any stealing order.
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+using namespace std;
+
+class Employee {
+private:
+    int idNum;
+    double hourlyRate;
+public:
+    Employee() : idNum(9999), hourlyRate(6.15) {}                   // default
+    Employee(int id, double rate) : idNum(id), hourlyRate(rate) {}   // param
+    int getId() const { return idNum; }
+    double getRate() const { return hourlyRate; }
+};
+
+struct EmployeeBatch {
+    vector<int32_t> id;
+    vector<uint16_t> department;
+    vector<int32_t> rateCents;    // per hour
+    vector<int32_t> hours;        // worked this period, in hundredths of an hour
+
+    size_t size() const { return id.size(); }
+    void reserve(size_t n) {
+        id.reserve(n); department.reserve(n); rateCents.reserve(n); hours.reserve(n);
+    }
+    // throws out_of_range for a department that does not fit the column
+    void add(const Employee& e, int dept, double hoursWorked) {
+        if (dept < 0 || dept > UINT16_MAX) throw out_of_range("department " + to_string(dept));
+        id.push_back(e.getId());
+        department.push_back(uint16_t(dept));
+        rateCents.push_back(int32_t(llround(e.getRate() * 100.0)));
+        hours.push_back(int32_t(llround(hoursWorked * 100.0)));
+    }
+};
+
+// Hours from `from` up to the next tier are paid at `percent` of the rate
+struct OvertimeTiers {
+    struct Tier {
+        int32_t from;      // hundredths of an hour
+        int32_t percent;
+    };
+    vector<Tier> tiers{ { 0, 100 }, { 4000, 150 }, { 6000, 200 } };   // 40h, then 60h
+
+    // pay in hundredth-hours * percent: rate * weighted / 10000 gives cents
+    int64_t weighted(int32_t hours) const {
+        int64_t w = 0;
+        for (size_t t = 0; t < tiers.size(); ++t) {
+            int32_t upTo = t + 1 < tiers.size() ? tiers[t + 1].from : INT32_MAX;
+            int32_t inTier = min(hours, upTo) - tiers[t].from;
+            w += int64_t(inTier > 0 ? inTier : 0) * tiers[t].percent;
+        }
+        return w;
+    }
+    int32_t regularHours(int32_t hours) const {
+        return tiers.size() > 1 ? min(hours, tiers[1].from) : hours;
+    }
+};
+
+class WorkStealingPool {
+private:
+    struct alignas(64) Queue {     // one worker's remaining chunks [begin, end)
+        mutex lock;
+        size_t begin{}, end{};
+    };
+    vector<thread> workers;
+    unique_ptr<Queue[]> queues;
+    unsigned count;
+    mutex lock;
+    condition_variable wake, done;
+    function<void(size_t)> task;
+    atomic<size_t> remaining{0};
+    atomic<size_t> steals{0};
+    uint64_t generation{};
+    bool stopping{false};
+
+    bool popOwn(unsigned w, size_t& chunk) {
+        Queue& q = queues[w];
+        lock_guard<mutex> guard(q.lock);
+        if (q.begin == q.end) return false;
+        chunk = q.begin++;
+        return true;
+    }
+    // takes the last chunk of the first victim that still has work
+    bool steal(unsigned w, size_t& chunk) {
+        for (unsigned k = 1; k < count; ++k) {
+            Queue& q = queues[(w + k) % count];
+            lock_guard<mutex> guard(q.lock);
+            if (q.begin == q.end) continue;
+            chunk = --q.end;
+            ++steals;
+            return true;
+        }
+        return false;
+    }
+    void run(unsigned w) {
+        uint64_t seen = 0;
+        for (;;) {
+            {
+                unique_lock<mutex> guard(lock);
+                wake.wait(guard, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+            size_t chunk;
+            while (popOwn(w, chunk) || steal(w, chunk)) {
+                task(chunk);
+                if (remaining.fetch_sub(1) == 1) {
+                    lock_guard<mutex> guard(lock);
+                    done.notify_all();
+                }
+            }
+        }
+    }
+public:
+    explicit WorkStealingPool(unsigned threads) : queues(new Queue[threads]), count(threads) {
+        for (unsigned t = 0; t < threads; ++t) workers.emplace_back(&WorkStealingPool::run, this, t);
+    }
+    ~WorkStealingPool() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (thread& t : workers) t.join();
+    }
+    unsigned threads() const { return count; }
+    size_t stealCount() const { return steals; }
+
+    // Calls f(chunk) once for every chunk in [0, chunks); returns when all are done
+    void forEachChunk(size_t chunks, function<void(size_t)> f) {
+        if (chunks == 0) return;
+        unique_lock<mutex> guard(lock);
+        task = std::move(f);
+        remaining = chunks;
+        steals = 0;
+        for (unsigned w = 0; w < count; ++w) {
+            lock_guard<mutex> g(queues[w].lock);
+            queues[w].begin = chunks * w / count;
+            queues[w].end = chunks * (w + 1) / count;
+        }
+        ++generation;
+        wake.notify_all();
+        done.wait(guard, [&] { return remaining.load() == 0; });
+    }
+};
+
+class PayrollRun {
+public:
+    struct DepartmentTotal {
+        int64_t grossCents{};
+        int64_t overtimeCents{};
+        int64_t hours{};          // hundredths
+        int64_t headcount{};
+        bool operator==(const DepartmentTotal& o) const {
+            return grossCents == o.grossCents && overtimeCents == o.overtimeCents &&
+                   hours == o.hours && headcount == o.headcount;
+        }
+    };
+
+    // rows per chunk: about 256 KiB of input and output columns
+    static const size_t CHUNK_ROWS = 256 * 1024 / (4 + 2 + 4 + 4 + 8 + 8);
+
+    PayrollRun(const OvertimeTiers& t, int departments) : tiers(t), departments(departments) {}
+
+    // Throws out_of_range, before paying anyone, if an employee's department
+    // is not below the run's department count
+    void run(const EmployeeBatch& batch, WorkStealingPool& pool) {
+        const size_t n = batch.size();
+        for (size_t x = 0; x < n; ++x)
+            if (batch.department[x] >= departments)
+                throw out_of_range("employee " + to_string(batch.id[x]) + " is in department " +
+                                   to_string(batch.department[x]) + ", but the run has " +
+                                   to_string(departments) + " departments");
+        const size_t chunks = (n + CHUNK_ROWS - 1) / CHUNK_ROWS;
+        gross.assign(n, 0);
+        overtime.assign(n, 0);
+        partial.assign(chunks * departments, DepartmentTotal());
+        pool.forEachChunk(chunks, [&](size_t c) { payChunk(batch, c); });
+
+        // merge in chunk order: independent of which thread ran which chunk
+        totals.assign(departments, DepartmentTotal());
+        for (size_t c = 0; c < chunks; ++c)
+            for (int d = 0; d < departments; ++d) {
+                const DepartmentTotal& p = partial[c * departments + d];
+                DepartmentTotal& t = totals[d];
+                t.grossCents += p.grossCents;
+                t.overtimeCents += p.overtimeCents;
+                t.hours += p.hours;
+                t.headcount += p.headcount;
+            }
+    }
+
+    const vector<int64_t>& grossCents() const { return gross; }
+    const vector<int64_t>& overtimeCents() const { return overtime; }
+    const vector<DepartmentTotal>& departmentTotals() const { return totals; }
+
+private:
+    const OvertimeTiers& tiers;
+    int departments;
+    vector<int64_t> gross, overtime;
+    vector<DepartmentTotal> partial;   // chunk * departments + department
+    vector<DepartmentTotal> totals;
+
+    void payChunk(const EmployeeBatch& b, size_t c) {
+        DepartmentTotal* dept = &partial[c * departments];
+        size_t end = min(b.size(), (c + 1) * CHUNK_ROWS);
+        for (size_t x = c * CHUNK_ROWS; x < end; ++x) {
+            int64_t rate = b.rateCents[x];
+            int64_t pay = (rate * tiers.weighted(b.hours[x]) + 5000) / 10000;
+            int64_t regular = (rate * tiers.regularHours(b.hours[x]) * 100 + 5000) / 10000;
+            gross[x] = pay;
+            overtime[x] = pay - regular;
+            DepartmentTotal& t = dept[b.department[x]];
+            t.grossCents += pay;
+            t.overtimeCents += pay - regular;
+            t.hours += b.hours[x];
+            ++t.headcount;
+        }
+    }
+};
+
+double seconds(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    Employee a;               // uses default
+    Employee b(101, 25.0);    // uses parameterized
+    OvertimeTiers tiers;
+    EmployeeBatch small;
+    small.add(a, 0, 38.0);
+    small.add(b, 1, 52.5);
+    WorkStealingPool one(1);
+    PayrollRun week(tiers, 2);
+    week.run(small, one);
+    cout << fixed << setprecision(2);
+    for (size_t x = 0; x < small.size(); ++x)
+        cout << small.id[x] << " @" << small.rateCents[x] / 100.0 << " for "
+             << small.hours[x] / 100.0 << "h: $" << week.grossCents()[x] / 100.0
+             << " (overtime $" << week.overtimeCents()[x] / 100.0 << ")\n";
+    small.add(Employee(102, 30.0), 2, 40.0);   // a department the run does not have
+    try {
+        week.run(small, one);
+    } catch (const out_of_range& e) {
+        cout << "Payroll rejected: " << e.what() << "\n";
+    }
+    try {
+        small.add(Employee(103, 30.0), -1, 40.0);
+    } catch (const out_of_range& e) {
+        cout << "Batch rejected " << e.what() << "\n";
+    }
+
+    // ---- 10^7 employees in 32 departments ----
+    const size_t N = 10000000;
+    const int DEPTS = 32;
+    mt19937 rng(8);
+    uniform_real_distribution<double> rate(7.25, 80.0), hours(10.0, 70.0);
+    uniform_int_distribution<int> dept(0, DEPTS - 1);
+    EmployeeBatch batch;
+    batch.reserve(N);
+    for (size_t x = 0; x < N; ++x)
+        batch.add(Employee(int(x), round(rate(rng) * 100.0) / 100.0), dept(rng), hours(rng));
+
+    cout << endl << setprecision(1) << thread::hardware_concurrency() << " hardware threads, "
+         << PayrollRun::CHUNK_ROWS << " employees per chunk" << endl;
+    PayrollRun reference(tiers, DEPTS);
+    bool first = true;
+    for (unsigned threads = 1; threads <= 8; threads *= 2) {
+        WorkStealingPool pool(threads);
+        PayrollRun run(tiers, DEPTS);
+        auto t = chrono::steady_clock::now();
+        run.run(batch, pool);
+        double s = seconds(t);
+        if (first) reference.run(batch, pool);
+        first = false;
+        bool same = run.departmentTotals() == reference.departmentTotals() &&
+                    run.grossCents() == reference.grossCents();
+        cout << setw(2) << threads << " threads: " << N / s / 1e6 << " M employees/s, "
+             << pool.stealCount() << " steals, totals "
+             << (same ? "identical" : "DIFFERENT") << endl;
+    }
+
+    int64_t payroll = 0, ot = 0;
+    for (const PayrollRun::DepartmentTotal& d : reference.departmentTotals()) {
+        payroll += d.grossCents;
+        ot += d.overtimeCents;
+    }
+    cout << setprecision(2) << "gross payroll $" << payroll / 100.0
+         << ", of which overtime $" << ot / 100.0 << endl;
+    return 0;
+}
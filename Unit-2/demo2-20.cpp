@@ -0,0 +1,288 @@
+// lifetime_tracking.cpp
+// Counting object lifetimes instead of printing from every constructor and
+// destructor like demo2-8's House does.
+// A class opts in by deriving from Tracked<itself>:
+//     class House : public Tracked<House> { ... };
+// Built normally, Tracked<T> is an empty base and costs nothing. Built with
+// -DTRACK_LIFETIMES it counts, per type: constructions, copies, moves,
+// copy/move assignments, destructions, and `new`s of the type with their
+// bytes. Classes that allocate buffers themselves add those with
+// Tracked<T>::noteBytes(n). Every thread counts into its own thread_local
+// block, so counting never takes a lock.
+// lifetimeReport(out) prints the totals at any time, and they are printed
+// once more when the program exits.
+// A class that writes its own copy constructor or copy assignment must pass
+// the Tracked base along, otherwise its copies are counted as constructions.
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <utility>
+#include <cstddef>
+#ifdef TRACK_LIFETIMES
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <new>
+#include <typeinfo>
+#include <cstdint>
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+using namespace std;
+
+#ifdef TRACK_LIFETIMES
+enum LifetimeEvent {
+    CONSTRUCTED, COPIED, MOVED, COPY_ASSIGNED, MOVE_ASSIGNED, DESTROYED,
+    ALLOCATIONS, BYTES, NUM_EVENTS
+};
+
+class LifetimeRegistry {
+public:
+    static const int MAX_TYPES = 64;
+
+    static LifetimeRegistry& instance() {
+        static LifetimeRegistry registry;
+        return registry;
+    }
+    ~LifetimeRegistry() { report(cout); }
+
+    int addType(const char* mangled) {
+        lock_guard<mutex> guard(lock);
+        if (types == MAX_TYPES) {
+            cerr << "lifetime tracking: more than " << MAX_TYPES << " types" << endl;
+            abort();
+        }
+        int status = 0;
+        unique_ptr<char, void (*)(void*)> name(abi::__cxa_demangle(mangled, nullptr, nullptr, &status), free);
+        names[types] = status == 0 ? name.get() : mangled;
+        return types++;
+    }
+
+    // Only the owning thread writes its counters; the relaxed load + store
+    // is a plain increment, yet report() may read it from another thread.
+    static void count(int type, LifetimeEvent e, uint64_t n = 1) {
+        atomic<uint64_t>& c = local().counts[type][e];
+        c.store(c.load(memory_order_relaxed) + n, memory_order_relaxed);
+    }
+
+    void report(ostream& out) {
+        lock_guard<mutex> guard(lock);
+        out << left << setw(14) << "type" << right << setw(10) << "ctor" << setw(10) << "copy"
+            << setw(10) << "move" << setw(10) << "copy=" << setw(10) << "move=" << setw(10)
+            << "dtor" << setw(10) << "live" << setw(10) << "news" << setw(14) << "bytes" << endl;
+        for (int t = 0; t < types; ++t) {
+            uint64_t n[NUM_EVENTS];
+            for (int e = 0; e < NUM_EVENTS; ++e) {
+                n[e] = retired[t][e];
+                for (Counters* c : threads) n[e] += c->counts[t][e].load(memory_order_relaxed);
+            }
+            int64_t live = int64_t(n[CONSTRUCTED] + n[COPIED] + n[MOVED]) - int64_t(n[DESTROYED]);
+            out << left << setw(14) << names[t] << right;
+            for (int e = CONSTRUCTED; e <= DESTROYED; ++e) out << setw(10) << n[e];
+            out << setw(10) << live << setw(10) << n[ALLOCATIONS] << setw(14) << n[BYTES] << endl;
+        }
+    }
+
+private:
+    struct Counters {
+        atomic<uint64_t> counts[MAX_TYPES][NUM_EVENTS] = {};
+    };
+    // one per thread; folds its counts into `retired` when the thread ends
+    struct ThreadCounters : Counters {
+        LifetimeRegistry& registry;
+        ThreadCounters() : registry(instance()) {
+            lock_guard<mutex> guard(registry.lock);
+            registry.threads.push_back(this);
+        }
+        ~ThreadCounters() {
+            lock_guard<mutex> guard(registry.lock);
+            for (int t = 0; t < MAX_TYPES; ++t)
+                for (int e = 0; e < NUM_EVENTS; ++e)
+                    registry.retired[t][e] += counts[t][e].load(memory_order_relaxed);
+            for (size_t i = 0; i < registry.threads.size(); ++i)
+                if (registry.threads[i] == this) {
+                    registry.threads[i] = registry.threads.back();
+                    registry.threads.pop_back();
+                    break;
+                }
+        }
+    };
+    static Counters& local() {
+        static thread_local ThreadCounters counters;
+        return counters;
+    }
+
+    mutex lock;
+    vector<Counters*> threads;
+    uint64_t retired[MAX_TYPES][NUM_EVENTS] = {};
+    string names[MAX_TYPES];
+    int types{};
+};
+
+template <typename T>
+class Tracked {
+private:
+    static int type() {
+        static const int t = LifetimeRegistry::instance().addType(typeid(T).name());
+        return t;
+    }
+    static void count(LifetimeEvent e) { LifetimeRegistry::count(type(), e); }
+protected:
+    Tracked() { count(CONSTRUCTED); }
+    Tracked(const Tracked&) { count(COPIED); }
+    Tracked(Tracked&&) noexcept { count(MOVED); }
+    Tracked& operator=(const Tracked&) { count(COPY_ASSIGNED); return *this; }
+    Tracked& operator=(Tracked&&) noexcept { count(MOVE_ASSIGNED); return *this; }
+    ~Tracked() { count(DESTROYED); }
+public:
+    static void noteBytes(size_t n) {
+        LifetimeRegistry::count(type(), ALLOCATIONS);
+        LifetimeRegistry::count(type(), BYTES, n);
+    }
+    static void* operator new(size_t n) { noteBytes(n); return ::operator new(n); }
+    static void* operator new[](size_t n) { noteBytes(n); return ::operator new[](n); }
+    static void operator delete(void* p) noexcept { ::operator delete(p); }
+    static void operator delete[](void* p) noexcept { ::operator delete[](p); }
+};
+
+inline void lifetimeReport(ostream& out) { LifetimeRegistry::instance().report(out); }
+#else
+// tracking compiled out: an empty base, and nothing to report
+template <typename T>
+class Tracked {
+public:
+    static void noteBytes(size_t) {}
+};
+
+inline void lifetimeReport(ostream& out) {
+    out << "(lifetime tracking is off: build with -DTRACK_LIFETIMES)" << endl;
+}
+#endif
+
+// ---------------- the classes being watched ----------------
+class House : public Tracked<House> {
+    int squareFeet;
+public:
+    House() : squareFeet(1000) {}   // no more "House created." / "House destroyed."
+    int getSquareFeet() const { return squareFeet; }
+};
+
+class Student : public Tracked<Student> {
+    int idNum{};
+    string name;
+public:
+    Student() = default;
+    Student(int id, string n) : idNum(id), name(std::move(n)) {}
+    int getId() const { return idNum; }
+    const string& getName() const { return name; }
+};
+
+// demo-3-6's Classroom, with a copy constructor and the base passed along
+class Classroom : public Tracked<Classroom> {
+    string* student;
+    int numStudents;
+    int gradeLevel;
+    void allocate() {
+        student = new string[numStudents];
+        noteBytes(sizeof(string) * numStudents);
+    }
+public:
+    Classroom(int grade, int n) : numStudents(n), gradeLevel(grade) {
+        allocate();
+        for (int x = 0; x < n; ++x) student[x] = "Student" + to_string(x);
+    }
+    Classroom(const Classroom& o) : Tracked(o), numStudents(o.numStudents), gradeLevel(o.gradeLevel) {
+        allocate();
+        for (int x = 0; x < numStudents; ++x) student[x] = o.student[x];
+    }
+    Classroom& operator=(const Classroom& o) {
+        if (this == &o) return *this;
+        Tracked::operator=(o);
+        delete[] student;
+        numStudents = o.numStudents;
+        gradeLevel = o.gradeLevel;
+        allocate();
+        for (int x = 0; x < numStudents; ++x) student[x] = o.student[x];
+        return *this;
+    }
+    ~Classroom() { delete[] student; }
+    int size() const { return numStudents; }
+    int getGradeLevel() const { return gradeLevel; }
+};
+
+// demo2-9's Transaction, reduced to what the loop below needs
+class Transaction : public Tracked<Transaction> {
+    int transNum{};
+    double price{};
+    string seller;
+public:
+    Transaction(int num, double pr, string salesName)
+        : transNum(num), price(pr), seller(std::move(salesName)) {}
+    double getPrice() const { return price; }
+};
+
+// ---------------- a hot loop with unwanted copies, and without ----------------
+double averageIdByValue(vector<Student> roster) {      // copies the whole roster
+    double sum = 0;
+    for (auto s : roster) sum += s.getId();            // ... and every student again
+    return sum / roster.size();
+}
+double averageId(const vector<Student>& roster) {
+    double sum = 0;
+    for (const auto& s : roster) sum += s.getId();
+    return sum / roster.size();
+}
+
+double ringUp(int count, bool reserve) {
+    vector<Transaction> sales;
+    if (reserve) sales.reserve(count);                 // no moves when the vector grows
+    for (int n = 0; n < count; ++n) sales.emplace_back(n, 19.95, "Lim");
+    double total = 0;
+    for (const Transaction& t : sales) total += t.getPrice();
+    return total;
+}
+
+double hotLoop(bool careful) {
+    vector<Student> roster;
+    for (int id = 0; id < 40; ++id) roster.emplace_back(id, "Student" + to_string(id));
+    double sum = 0;
+    for (int pass = 0; pass < 5000; ++pass)
+        sum += careful ? averageId(roster) : averageIdByValue(roster);
+    return sum + ringUp(20000, careful);
+}
+
+double seconds(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    {
+        House h;
+        cout << "Square feet: " << h.getSquareFeet() << "\n";
+        House* extra = new House;   // counted as one `new` of sizeof(House) bytes
+        delete extra;
+        Classroom a(5, 30), b(6, 2);
+        b = a;                      // one copy assignment, 30 strings reallocated
+        Classroom c(a);             // one copy
+    }
+    lifetimeReport(cout);
+
+    // two threads, each running the careless loop then the careful one
+    cout << endl << fixed << setprecision(1);
+    for (bool careful : { false, true }) {
+        auto t = chrono::steady_clock::now();
+        double result[2];
+        vector<thread> threads;
+        for (int w = 0; w < 2; ++w)
+            threads.emplace_back([&, w] { result[w] = hotLoop(careful); });
+        for (thread& th : threads) th.join();
+        cout << (careful ? "by reference, reserved: " : "by value, unreserved:   ") << seconds(t) * 1e3
+             << " ms (" << (result[0] == result[1] ? "same" : "different") << " results)" << endl;
+        lifetimeReport(cout);
+        cout << endl;
+    }
+    return 0;
+}
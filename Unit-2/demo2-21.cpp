@@ -0,0 +1,494 @@
+// transaction_journal.cpp
+// Durable capture for demo2-9's Transactions.
+//  - TransactionRecord: a fixed 64-byte binary layout with a checksum
+//  - TransactionJournal: appends records into memory-mapped segment files
+//    (journal-<first sequence>.seg, preallocated), starting a new segment
+//    when one is full. Appending is a copy into the mapping; a background
+//    thread msyncs what was appended since the last sync (group commit)
+//    when a group is full or at the latest every maxDelay.
+//  - JournalReader: maps the segments read-only and hands out references
+//    to the records where they lie, no copies
+// Reopening a journal continues after its last valid record, so a crash
+// loses at most the records that were not yet synced.
+//
+//   ./demo2-21 [dir]     benchmark in dir (default: a fresh temporary dir)
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <stdexcept>
+#include <type_traits>
+#include <cmath>
+#include <utility>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+using namespace std;
+
+// ---------------- demo2-9's classes, with getters ----------------
+class InventoryItem {
+    int stockNum{};
+    double price{};
+public:
+    InventoryItem() = default;
+    InventoryItem(int s, double p) : stockNum(s), price(p) {}
+    int getStockNum() const { return stockNum; }
+    double getPrice() const { return price; }
+};
+
+class Salesperson {
+    int idNum{};
+    string name;
+public:
+    Salesperson() = default;
+    Salesperson(int id, string n) : idNum(id), name(std::move(n)) {}
+    int getIdNum() const { return idNum; }
+    const string& getName() const { return name; }
+};
+
+class Transaction {
+    int transNum{};
+    InventoryItem itemSold;
+    Salesperson seller;
+public:
+    Transaction(int num, int item, double pr, int salesId, string salesName)
+        : transNum(num), itemSold(item, pr), seller(salesId, std::move(salesName)) {}
+    int getTransNum() const { return transNum; }
+    const InventoryItem& getItem() const { return itemSold; }
+    const Salesperson& getSeller() const { return seller; }
+};
+
+// ---------------- on-disk layout ----------------
+struct TransactionRecord {
+    uint64_t sequence;        // 1, 2, 3, ... across all segments; 0 = empty slot
+    int64_t timestampNs;      // system_clock, since the epoch
+    int64_t priceCents;
+    int32_t transNum;
+    int32_t stockNum;
+    int32_t salesId;
+    char salesName[20];       // NUL-padded, truncated to 20 bytes
+    uint32_t checksum;        // over the 56 bytes above
+    uint32_t reserved;
+
+    uint32_t computeChecksum() const {
+        uint64_t words[7];
+        memcpy(words, this, sizeof(words));
+        uint64_t h = 0x6A09E667F3BCC908ull;
+        for (uint64_t w : words) {
+            h = (h ^ w) * 0x9E3779B97F4A7C15ull;
+            h ^= h >> 32;
+        }
+        return uint32_t(h);
+    }
+    string getSalesName() const { return string(salesName, strnlen(salesName, sizeof(salesName))); }
+};
+static_assert(sizeof(TransactionRecord) == 64, "records are one cache line");
+static_assert(is_trivially_copyable<TransactionRecord>::value, "records are copied as bytes");
+
+struct SegmentHeader {
+    char magic[8];            // "TXJRNL01"
+    uint64_t firstSequence;
+    uint64_t capacity;        // records
+    uint32_t recordSize;
+    char unused[36];
+};
+static_assert(sizeof(SegmentHeader) == 64, "header is one record long");
+
+const char JOURNAL_MAGIC[8] = { 'T', 'X', 'J', 'R', 'N', 'L', '0', '1' };
+
+string segmentPath(const string& dir, uint64_t firstSequence) {
+    char name[48];
+    snprintf(name, sizeof(name), "/journal-%020llu.seg", (unsigned long long)firstSequence);
+    return dir + name;
+}
+
+// every segment file in dir, oldest first
+vector<string> listSegments(const string& dir) {
+    vector<string> names;
+    if (DIR* d = opendir(dir.c_str())) {
+        while (dirent* e = readdir(d)) {
+            string n = e->d_name;
+            if (n.size() == 32 && n.compare(0, 8, "journal-") == 0 && n.compare(28, 4, ".seg") == 0)
+                names.push_back(dir + "/" + n);
+        }
+        closedir(d);
+    }
+    sort(names.begin(), names.end());   // zero-padded sequence numbers sort by name
+    return names;
+}
+
+// ---------------- writer ----------------
+struct JournalOptions {
+    uint64_t segmentRecords = 1 << 20;           // 64 MiB segments
+    uint64_t groupRecords = 1 << 14;             // sync early once this many wait
+    chrono::milliseconds maxDelay{5};            // ... and never later than this
+};
+
+struct JournalSyncStats {
+    uint64_t syncs{};
+    double totalSeconds{};
+    double maxSeconds{};
+};
+
+class TransactionJournal {
+public:
+    TransactionJournal(const string& dir, const JournalOptions& opt = JournalOptions()) : dir(dir), opt(opt) {
+        vector<string> existing = listSegments(dir);
+        if (existing.empty()) install(openSegment(1, true));
+        else resume(existing.back());
+        syncer = thread(&TransactionJournal::syncLoop, this);
+    }
+    ~TransactionJournal() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_one();
+        syncer.join();
+        closeSegment();
+    }
+    TransactionJournal(const TransactionJournal&) = delete;
+    TransactionJournal& operator=(const TransactionJournal&) = delete;
+
+    // Copies t into the journal; returns its sequence number. Durable after
+    // waitDurable(sequence), or at the latest about maxDelay later.
+    uint64_t append(const Transaction& t) {
+        if (count == seg.capacity) rollover();
+        TransactionRecord& r = seg.records[count];
+        r.sequence = nextSequence;
+        r.timestampNs = chrono::duration_cast<chrono::nanoseconds>(
+            chrono::system_clock::now().time_since_epoch()).count();
+        r.priceCents = llround(t.getItem().getPrice() * 100.0);
+        r.transNum = t.getTransNum();
+        r.stockNum = t.getItem().getStockNum();
+        r.salesId = t.getSeller().getIdNum();
+        const string& name = t.getSeller().getName();
+        size_t n = min(name.size(), sizeof(r.salesName));
+        memcpy(r.salesName, name.data(), n);
+        memset(r.salesName + n, 0, sizeof(r.salesName) - n);
+        r.checksum = r.computeChecksum();
+        r.reserved = 0;
+        appended.store(++count, memory_order_release);
+        if (nextSequence - lastWake >= opt.groupRecords) {   // a full group: sync now
+            lastWake = nextSequence;
+            wake.notify_one();
+        }
+        return nextSequence++;
+    }
+
+    void sync() {
+        lock_guard<mutex> guard(lock);
+        syncLocked();
+    }
+    void waitDurable(uint64_t sequence) {
+        unique_lock<mutex> guard(lock);
+        wake.notify_one();
+        synced.wait(guard, [&] { return durable.load() >= sequence; });
+    }
+    uint64_t durableSequence() const { return durable.load(); }
+    uint64_t lastSequence() const { return nextSequence - 1; }
+    JournalSyncStats syncStats() {
+        lock_guard<mutex> guard(lock);
+        return stats;
+    }
+
+private:
+    struct Segment {
+        int fd{-1};
+        char* base{nullptr};
+        size_t bytes{};
+        uint64_t firstSequence{};
+        uint64_t capacity{};
+        TransactionRecord* records{nullptr};
+    };
+    string dir;
+    JournalOptions opt;
+    Segment seg;               // replaced only by the appending thread, under `lock`
+    uint64_t count{};          // records in seg (appending thread only)
+    uint64_t nextSequence{1};
+    uint64_t lastWake{};
+    atomic<uint64_t> appended{0};    // count, published to the syncer
+    uint64_t syncedCount{};          // records of seg already synced (under `lock`)
+    atomic<uint64_t> durable{0};
+    JournalSyncStats stats;
+    mutex lock;
+    condition_variable wake, synced;
+    bool stopping{false};
+    thread syncer;
+
+    static void fail(const string& what) {
+        throw runtime_error(what + ": " + strerror(errno));
+    }
+
+    // Maps a segment file; touches no member, so a failure leaves the
+    // journal as it was
+    Segment openSegment(uint64_t firstSequence, bool create) {
+        string path = segmentPath(dir, firstSequence);
+        int fd = open(path.c_str(), create ? O_RDWR | O_CREAT | O_EXCL : O_RDWR, 0644);
+        if (fd < 0) fail("open " + path);
+        size_t bytes = sizeof(SegmentHeader) + opt.segmentRecords * sizeof(TransactionRecord);
+        if (create) {
+            // reserve the blocks now, so a full disk fails here and not as a SIGBUS later
+            int err = posix_fallocate(fd, 0, off_t(bytes));
+            if (err == EOPNOTSUPP || err == EINVAL) err = ftruncate(fd, off_t(bytes)) == 0 ? 0 : errno;
+            if (err != 0) {
+                errno = err;
+                close(fd);
+                unlink(path.c_str());   // so a later rollover can try again
+                fail("allocate " + path);
+            }
+        } else {
+            struct stat st;
+            if (fstat(fd, &st) != 0) {
+                int err = errno;
+                close(fd);
+                errno = err;
+                fail("stat " + path);
+            }
+            bytes = size_t(st.st_size);
+        }
+        void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            int err = errno;
+            close(fd);
+            if (create) unlink(path.c_str());
+            errno = err;
+            fail("mmap " + path);
+        }
+        SegmentHeader* h = static_cast<SegmentHeader*>(p);
+        if (create) {
+            memcpy(h->magic, JOURNAL_MAGIC, sizeof(h->magic));
+            h->firstSequence = firstSequence;
+            h->capacity = opt.segmentRecords;
+            h->recordSize = sizeof(TransactionRecord);
+            msync(p, sizeof(SegmentHeader), MS_SYNC);
+            // make the new file's directory entry durable too
+            int dfd = open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+            if (dfd >= 0) {
+                fsync(dfd);
+                close(dfd);
+            }
+        } else if (memcmp(h->magic, JOURNAL_MAGIC, sizeof(h->magic)) != 0 ||
+                   h->recordSize != sizeof(TransactionRecord) ||
+                   bytes < sizeof(SegmentHeader) + h->capacity * sizeof(TransactionRecord)) {
+            munmap(p, bytes);
+            close(fd);
+            throw runtime_error("not a journal segment: " + path);
+        }
+        Segment s;
+        s.fd = fd;
+        s.base = static_cast<char*>(p);
+        s.bytes = bytes;
+        s.firstSequence = h->firstSequence;
+        s.capacity = h->capacity;
+        s.records = reinterpret_cast<TransactionRecord*>(s.base + sizeof(SegmentHeader));
+        madvise(s.records, s.capacity * sizeof(TransactionRecord), MADV_SEQUENTIAL);
+        return s;
+    }
+
+    // makes s the segment appends go to, starting at its first record
+    void install(const Segment& s) {
+        seg = s;
+        count = syncedCount = 0;
+        appended.store(0);
+    }
+
+    // reopen the newest segment and continue after its last valid record
+    void resume(const string& path) {
+        uint64_t first = strtoull(path.c_str() + path.size() - 24, nullptr, 10);
+        install(openSegment(first, false));
+        uint64_t n = 0;
+        while (n < seg.capacity && seg.records[n].sequence == first + n &&
+               seg.records[n].checksum == seg.records[n].computeChecksum())
+            ++n;
+        // clear a torn tail, so a reader never mistakes it for records
+        if (n < seg.capacity) memset(&seg.records[n], 0, (seg.capacity - n) * sizeof(TransactionRecord));
+        count = syncedCount = n;
+        appended.store(n);
+        nextSequence = first + n;
+        lastWake = nextSequence - 1;
+        durable.store(nextSequence - 1);
+    }
+
+    void closeSegment() {
+        if (!seg.base) return;
+        syncLocked();
+        munmap(seg.base, seg.bytes);
+        close(seg.fd);
+        seg = Segment();
+    }
+
+    // The next segment is opened before the full one is closed. If that
+    // throws, the full segment stays current and count == capacity, so the
+    // next append tries the rollover again instead of writing anywhere.
+    void rollover() {
+        lock_guard<mutex> guard(lock);
+        Segment next = openSegment(nextSequence, true);
+        closeSegment();
+        install(next);
+    }
+
+    // msync the pages appended since the last sync (caller holds `lock`)
+    void syncLocked() {
+        uint64_t n = appended.load(memory_order_acquire);
+        if (n == syncedCount) return;
+        const size_t page = size_t(sysconf(_SC_PAGESIZE));
+        size_t from = sizeof(SegmentHeader) + syncedCount * sizeof(TransactionRecord);
+        size_t to = sizeof(SegmentHeader) + n * sizeof(TransactionRecord);
+        from -= from % page;
+        auto t = chrono::steady_clock::now();
+        msync(seg.base + from, to - from, MS_SYNC);
+        double s = chrono::duration<double>(chrono::steady_clock::now() - t).count();
+        ++stats.syncs;
+        stats.totalSeconds += s;
+        stats.maxSeconds = max(stats.maxSeconds, s);
+        syncedCount = n;
+        durable.store(seg.firstSequence + n - 1);
+        synced.notify_all();
+    }
+
+    void syncLoop() {
+        unique_lock<mutex> guard(lock);
+        while (!stopping) {
+            wake.wait_for(guard, opt.maxDelay);
+            syncLocked();
+        }
+    }
+};
+
+// ---------------- zero-copy reader ----------------
+class JournalReader {
+private:
+    struct Mapping {
+        const char* base;
+        size_t bytes;
+    };
+    vector<Mapping> maps;
+public:
+    explicit JournalReader(const string& dir) {
+        for (const string& path : listSegments(dir)) {
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) continue;
+            struct stat st;
+            if (fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(SegmentHeader)) {
+                void* p = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+                if (p != MAP_FAILED) {
+                    madvise(p, size_t(st.st_size), MADV_SEQUENTIAL);
+                    maps.push_back(Mapping{ static_cast<const char*>(p), size_t(st.st_size) });
+                }
+            }
+            close(fd);
+        }
+    }
+    ~JournalReader() {
+        for (const Mapping& m : maps) munmap(const_cast<char*>(m.base), m.bytes);
+    }
+    JournalReader(const JournalReader&) = delete;
+    JournalReader& operator=(const JournalReader&) = delete;
+
+    // Calls f(const TransactionRecord&) on every valid record, in order, in
+    // place in the mapping. Stops at the first gap or damaged record and
+    // returns the number of records visited.
+    template <typename F>
+    uint64_t forEach(F f) const {
+        uint64_t visited = 0;
+        for (const Mapping& m : maps) {
+            const SegmentHeader* h = reinterpret_cast<const SegmentHeader*>(m.base);
+            if (memcmp(h->magic, JOURNAL_MAGIC, sizeof(h->magic)) != 0 ||
+                h->recordSize != sizeof(TransactionRecord)) return visited;
+            const TransactionRecord* r = reinterpret_cast<const TransactionRecord*>(m.base + sizeof(SegmentHeader));
+            uint64_t n = min<uint64_t>(h->capacity, (m.bytes - sizeof(SegmentHeader)) / sizeof(TransactionRecord));
+            for (uint64_t x = 0; x < n; ++x) {
+                if (r[x].sequence != h->firstSequence + x || r[x].checksum != r[x].computeChecksum())
+                    return visited;
+                f(r[x]);
+                ++visited;
+            }
+        }
+        return visited;
+    }
+};
+
+double seconds(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    string dir;
+    bool temporary = argc < 2;
+    if (temporary) {
+        char tmpl[] = "/tmp/journalXXXXXX";
+        if (!mkdtemp(tmpl)) {
+            perror("mkdtemp");
+            return 1;
+        }
+        dir = tmpl;
+    } else {
+        dir = argv[1];
+    }
+
+    const uint64_t N = 4000000;
+    uint64_t expected = 0;   // every sequence so far, including earlier runs in dir
+    JournalOptions opt;
+    opt.segmentRecords = 1 << 18;   // 16 MiB segments, so the run below rolls over
+    try {
+        {
+            TransactionJournal journal(dir, opt);
+            uint64_t s = journal.append(Transaction(9001, 555, 19.95, 77, "Lim"));
+            journal.waitDurable(s);
+            cout << "Transaction #9001 durable as record " << s << " in " << dir << "\n";
+        }
+
+        // ---- 4 * 10^6 more transactions ----
+        TransactionJournal journal(dir, opt);   // reopens: continues after record 1
+        vector<Transaction> sales;
+        sales.reserve(1000);
+        for (int x = 0; x < 1000; ++x)
+            sales.emplace_back(10000 + x, 100 + x % 50, 1.99 + x % 100, x % 40, "Seller" + to_string(x % 40));
+
+        auto t = chrono::steady_clock::now();
+        uint64_t last = 0;
+        for (uint64_t x = 0; x < N; ++x) last = journal.append(sales[x % sales.size()]);
+        double appendSec = seconds(t);
+        journal.waitDurable(last);
+        double durableSec = seconds(t);
+        expected = last;
+
+        JournalSyncStats st = journal.syncStats();
+        cout << fixed << setprecision(2) << endl;
+        cout << "appended " << N << " records: " << N / appendSec / 1e6 << " M/s, all durable after "
+             << durableSec << " s (" << N / durableSec / 1e6 << " M/s)" << endl;
+        cout << st.syncs << " group commits, msync mean " << st.totalSeconds / st.syncs * 1e3
+             << " ms, max " << st.maxSeconds * 1e3 << " ms" << endl;
+    } catch (const exception& e) {
+        cout << "journal error: " << e.what() << endl;
+        return 1;
+    }
+
+    JournalReader reader(dir);
+    auto t = chrono::steady_clock::now();
+    int64_t cents = 0;
+    uint64_t seen = reader.forEach([&](const TransactionRecord& r) { cents += r.priceCents; });
+    double readSec = seconds(t);
+    cout << "read back " << seen << " records in place: " << seen / readSec / 1e6 << " M/s, $"
+         << cents / 100 << "." << setw(2) << setfill('0') << cents % 100 << setfill(' ') << endl;
+
+    if (temporary) {
+        for (const string& path : listSegments(dir)) unlink(path.c_str());
+        rmdir(dir.c_str());
+    }
+    return seen == expected ? 0 : 1;
+}
@@ -0,0 +1,398 @@
+// sales_leaderboard.cpp
+// Live top-K rankings of demo2-10's Salespeople by revenue over sliding
+// windows (last minute, hour, day) of a stream of sales.
+// A window is a ring of time buckets; each bucket remembers how much each
+// salesperson sold in it, so when the bucket falls out of the window its
+// amounts are subtracted again. Memory depends on the number of buckets and
+// of active salespeople, never on how long the stream has run.
+// The leaders sit in a min-heap of K entries with positions stored in the
+// totals map; everyone else is offered to a lazy max-heap of candidates:
+//  - a sale only raises a total: a leader is sifted in O(log K), an
+//    outsider either replaces the weakest leader or is pushed as a
+//    candidate with its new total
+//  - when a bucket expires, only the sellers in it change: a leader that
+//    fell is sifted toward the root (or removed at zero), an outsider is
+//    pushed again; then the best candidates are promoted while they rank
+//    above the weakest leader
+//  - candidate entries whose total is out of date are skipped when they
+//    surface, and the candidate heap is compacted once it holds more than
+//    twice the active sellers
+//  - top() copies the K leaders out and sorts them, O(K log K)
+// Costs: a sale to a leader is O(log K). A sale to anyone else is one
+// push onto the candidate heap, O(log S) for S active sellers, not
+// O(log K): totals also fall as buckets expire, and an exact top K then
+// needs to know the best outsider, which a structure bounded by K cannot
+// remember. Expiring a bucket costs O(log S) per seller in it.
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <utility>
+#include <cstdint>
+#include <stdexcept>
+using namespace std;
+
+// demo2-10's Salesperson, with getters
+class Salesperson {
+private:
+    int idNum;
+    string name;
+public:
+    Salesperson(int id, string n) : idNum(id), name(std::move(n)) {}
+    int getIdNum() const { return idNum; }
+    const string& getName() const { return name; }
+    void display() const {
+        cout << "Salesperson #" << idNum << " " << name << "\n";
+    }
+};
+
+struct Sale {
+    int64_t time;      // seconds
+    int salesId;
+    int64_t cents;
+};
+
+struct Ranking {
+    int salesId;
+    int64_t cents;
+};
+
+class SlidingLeaderboard {
+public:
+    // window = buckets * bucketSeconds; keeps the top k
+    // Throws invalid_argument unless all three are at least 1
+    SlidingLeaderboard(int64_t bucketSeconds, int buckets, int k)
+        : width(bucketSeconds), ring(size_t(max(buckets, 1))), k(size_t(max(k, 1))) {
+        if (bucketSeconds < 1 || buckets < 1 || k < 1)
+            throw invalid_argument("a leaderboard needs positive bucket width, bucket count and k");
+        heap.reserve(this->k);
+    }
+
+    void add(const Sale& s) {
+        int64_t start = floorDiv(s.time, width) * width;
+        if (start > head) advance(start);
+        Bucket& b = ring[slotOf(start)];
+        if (b.start != start) {   // older than the window, or its bucket was already reused
+            ++late;
+            return;
+        }
+        b.cents[s.salesId] += s.cents;
+        Seller& seller = totals[s.salesId];
+        seller.cents += s.cents;
+        raise(s.salesId, seller);
+    }
+
+    // The leaders, best first; sorting them is O(K log K)
+    vector<Ranking> top() const {
+        vector<Ranking> out;
+        out.reserve(heap.size());
+        for (const Leader& l : heap) out.push_back(Ranking{ l.salesId, l.seller->cents });
+        sort(out.begin(), out.end(), [](const Ranking& a, const Ranking& b) { return ranksAbove(a, b); });
+        return out;
+    }
+
+    // sales at or after this time are in the window (all of them before the first add)
+    int64_t windowStart() const {
+        return head == INT64_MIN ? INT64_MIN : head - width * int64_t(ring.size() - 1);
+    }
+    size_t activeSellers() const { return totals.size(); }
+    uint64_t lateSales() const { return late; }
+
+private:
+    struct Bucket {
+        int64_t start{INT64_MIN};
+        unordered_map<int, int64_t> cents;   // salesId -> sold in this bucket
+    };
+    struct Seller {
+        int64_t cents{};
+        int heapPos{-1};
+    };
+    struct Leader {
+        int salesId;
+        Seller* seller;   // map nodes do not move, so this stays valid until erased
+    };
+    struct Candidate {
+        int64_t cents;    // the seller's total when this entry was pushed
+        int salesId;
+    };
+    int64_t width;
+    vector<Bucket> ring;
+    int64_t head{INT64_MIN};             // start of the newest bucket
+    unordered_map<int, Seller> totals;   // salespeople with sales in the window
+    vector<Leader> heap;                 // weakest leader at the root
+    vector<Candidate> outside;           // strongest candidate at the root; may hold stale entries
+    size_t k;
+    uint64_t late{};
+
+    // rounds toward minus infinity, so negative times find the right bucket
+    static int64_t floorDiv(int64_t a, int64_t b) {
+        int64_t q = a / b;
+        return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+    }
+
+    size_t slotOf(int64_t start) const {
+        int64_t n = int64_t(ring.size());
+        return size_t(((start / width) % n + n) % n);
+    }
+
+    // higher revenue first; the lower id wins a tie, so the ranking is stable
+    static bool ranksAbove(const Ranking& a, const Ranking& b) {
+        return a.cents != b.cents ? a.cents > b.cents : a.salesId < b.salesId;
+    }
+    static bool weaker(const Leader& a, const Leader& b) {
+        return ranksAbove(Ranking{ b.salesId, b.seller->cents }, Ranking{ a.salesId, a.seller->cents });
+    }
+    static bool candidateBelow(const Candidate& a, const Candidate& b) {
+        return ranksAbove(Ranking{ b.salesId, b.cents }, Ranking{ a.salesId, a.cents });
+    }
+
+    void place(size_t pos, const Leader& l) {
+        heap[pos] = l;
+        l.seller->heapPos = int(pos);
+    }
+    void siftDown(size_t pos) {
+        for (;;) {
+            size_t weakest = pos, l = 2 * pos + 1, r = l + 1;
+            if (l < heap.size() && weaker(heap[l], heap[weakest])) weakest = l;
+            if (r < heap.size() && weaker(heap[r], heap[weakest])) weakest = r;
+            if (weakest == pos) return;
+            Leader moved = heap[pos];
+            place(pos, heap[weakest]);
+            place(weakest, moved);
+            pos = weakest;
+        }
+    }
+    void siftUp(size_t pos) {
+        while (pos > 0) {
+            size_t parent = (pos - 1) / 2;
+            if (!weaker(heap[pos], heap[parent])) return;
+            Leader moved = heap[pos];
+            place(pos, heap[parent]);
+            place(parent, moved);
+            pos = parent;
+        }
+    }
+
+    // seller's total just went up
+    void raise(int id, Seller& seller) {
+        if (seller.heapPos >= 0) {
+            siftDown(size_t(seller.heapPos));   // stronger now: moves away from the root
+        } else if (heap.size() < k) {
+            heap.push_back(Leader{ id, &seller });
+            seller.heapPos = int(heap.size() - 1);
+            siftUp(heap.size() - 1);
+        } else if (weaker(heap[0], Leader{ id, &seller })) {
+            Leader out = heap[0];
+            out.seller->heapPos = -1;
+            place(0, Leader{ id, &seller });
+            siftDown(0);
+            offer(out.salesId, *out.seller);
+        } else {
+            offer(id, seller);
+        }
+    }
+
+    void offer(int id, const Seller& seller) {
+        outside.push_back(Candidate{ seller.cents, id });
+        push_heap(outside.begin(), outside.end(), candidateBelow);
+        if (outside.size() > 2 * totals.size() + 1024) compact();
+    }
+
+    // drops stale entries: one per outsider, with its current total
+    void compact() {
+        outside.clear();
+        for (const auto& entry : totals)
+            if (entry.second.heapPos < 0) outside.push_back(Candidate{ entry.second.cents, entry.first });
+        make_heap(outside.begin(), outside.end(), candidateBelow);
+    }
+
+    // the best outsider, after discarding entries that are out of date
+    Seller* bestCandidate() {
+        while (!outside.empty()) {
+            const Candidate& c = outside.front();
+            auto it = totals.find(c.salesId);
+            if (it != totals.end() && it->second.heapPos < 0 && it->second.cents == c.cents) return &it->second;
+            pop_heap(outside.begin(), outside.end(), candidateBelow);
+            outside.pop_back();
+        }
+        return nullptr;
+    }
+
+    void removeLeader(size_t pos) {
+        heap[pos].seller->heapPos = -1;
+        Leader last = heap.back();
+        heap.pop_back();
+        if (pos == heap.size()) return;
+        place(pos, last);
+        siftUp(pos);
+        siftDown(size_t(last.seller->heapPos));
+    }
+
+    // after leaders lost revenue: promote outsiders that now rank higher
+    void promote() {
+        while (Seller* best = bestCandidate()) {
+            int id = outside.front().salesId;
+            if (heap.size() >= k && !weaker(heap[0], Leader{ id, best })) return;
+            pop_heap(outside.begin(), outside.end(), candidateBelow);
+            outside.pop_back();
+            if (heap.size() < k) {
+                heap.push_back(Leader{ id, best });
+                best->heapPos = int(heap.size() - 1);
+                siftUp(heap.size() - 1);
+            } else {
+                Leader out = heap[0];
+                out.seller->heapPos = -1;
+                place(0, Leader{ id, best });
+                siftDown(0);
+                offer(out.salesId, *out.seller);
+            }
+        }
+    }
+
+    // Moves the window forward so its newest bucket starts at `start`.
+    // Only the sellers in the expiring buckets change: a leader who drops
+    // is sifted toward the root, an outsider is offered again with its
+    // lower total, and then any outsider who now ranks above the weakest
+    // leader is promoted.
+    void advance(int64_t start) {
+        bool leaderDropped = false;
+        int64_t steps = head == INT64_MIN ? int64_t(ring.size()) : (start - head) / width;
+        steps = min<int64_t>(steps, int64_t(ring.size()));
+        for (int64_t s = steps - 1; s >= 0; --s) {
+            Bucket& b = ring[slotOf(start - s * width)];
+            for (const auto& entry : b.cents) {
+                auto it = totals.find(entry.first);
+                Seller& seller = it->second;
+                seller.cents -= entry.second;
+                if (seller.heapPos >= 0) {
+                    leaderDropped = true;
+                    if (seller.cents == 0) {
+                        removeLeader(size_t(seller.heapPos));
+                        totals.erase(it);
+                    } else {
+                        siftUp(size_t(seller.heapPos));   // weaker now: moves toward the root
+                    }
+                } else if (seller.cents == 0) {
+                    totals.erase(it);   // its candidate entries go stale
+                } else {
+                    offer(entry.first, seller);
+                }
+            }
+            b.cents.clear();
+            b.start = start - s * width;
+        }
+        head = start;
+        if (leaderDropped) promote();
+    }
+};
+
+// last minute, hour and day, as used by the sales floor screens
+class Leaderboards {
+public:
+    SlidingLeaderboard minute, hour, day;
+    explicit Leaderboards(int k) : minute(1, 60, k), hour(60, 60, k), day(1800, 48, k) {}
+    void add(const Sale& s) {
+        minute.add(s);
+        hour.add(s);
+        day.add(s);
+    }
+};
+
+// recomputes a window from every sale it still holds, for checking
+vector<Ranking> bruteForceTop(const deque<Sale>& sales, int64_t from, size_t k) {
+    unordered_map<int, int64_t> sum;
+    for (const Sale& s : sales)
+        if (s.time >= from) sum[s.salesId] += s.cents;
+    vector<Ranking> all;
+    for (const auto& e : sum) all.push_back(Ranking{ e.first, e.second });
+    auto better = [](const Ranking& a, const Ranking& b) {
+        return a.cents != b.cents ? a.cents > b.cents : a.salesId < b.salesId;
+    };
+    size_t n = min(k, all.size());
+    partial_sort(all.begin(), all.begin() + n, all.end(), better);
+    all.resize(n);
+    return all;
+}
+
+bool sameRanking(const vector<Ranking>& a, const vector<Ranking>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t x = 0; x < a.size(); ++x)
+        if (a[x].salesId != b[x].salesId || a[x].cents != b[x].cents) return false;
+    return true;
+}
+
+double seconds(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    vector<Salesperson> staff = { Salesperson(77, "Lim"), Salesperson(78, "Okafor"),
+                                  Salesperson(79, "Reyes") };
+    Leaderboards boards(2);
+    boards.add(Sale{ 0, 77, 1995 });
+    boards.add(Sale{ 30, 78, 4500 });
+    boards.add(Sale{ 90, 79, 2500 });   // Lim's and Okafor's sales leave the minute window
+    cout << "Top of the last minute:\n";
+    for (const Ranking& r : boards.minute.top())
+        for (const Salesperson& p : staff)
+            if (p.getIdNum() == r.salesId) p.display();
+    cout << "Top of the last hour:\n";
+    for (const Ranking& r : boards.hour.top())
+        for (const Salesperson& p : staff)
+            if (p.getIdNum() == r.salesId) p.display();
+
+    // ---- 10^7 sales by 10^4 salespeople over two simulated days ----
+    const int SELLERS = 10000, K = 10;
+    const int64_t SALES = 10000000, SPAN = 2 * 86400;
+    mt19937_64 rng(9);
+    uniform_int_distribution<int64_t> cents(100, 50000);
+    vector<int> who(1 << 16);   // a few salespeople sell far more than the rest
+    for (int& w : who) {
+        double u = uniform_real_distribution<double>(0.0, 1.0)(rng);
+        w = int(SELLERS * u * u * u);
+    }
+    vector<Sale> stream(SALES);
+    for (int64_t x = 0; x < SALES; ++x)
+        stream[x] = Sale{ x * SPAN / SALES, who[rng() & 0xFFFF], cents(rng) };
+
+    Leaderboards live(K);
+    deque<Sale> lastDay;
+    size_t checks = 0, mismatches = 0;
+    double queryTime = 0;
+    auto t = chrono::steady_clock::now();
+    for (int64_t x = 0; x < SALES; ++x) {
+        live.add(stream[x]);
+        if (x % 1000000 == 999999) {     // check all three windows now and then
+            double updateSoFar = seconds(t);
+            for (int64_t y = x - 999999; y <= x; ++y) lastDay.push_back(stream[y]);
+            while (lastDay.front().time < live.day.windowStart()) lastDay.pop_front();
+            SlidingLeaderboard* windows[] = { &live.minute, &live.hour, &live.day };
+            for (SlidingLeaderboard* w : windows) {
+                auto q = chrono::steady_clock::now();
+                vector<Ranking> top = w->top();
+                queryTime += seconds(q);
+                ++checks;
+                mismatches += !sameRanking(top, bruteForceTop(lastDay, w->windowStart(), K));
+            }
+            t = chrono::steady_clock::now() - chrono::duration_cast<chrono::steady_clock::duration>(
+                chrono::duration<double>(updateSoFar));
+        }
+    }
+    double updateSec = seconds(t);
+
+    cout << endl << fixed << setprecision(1);
+    cout << SALES / updateSec / 1e6 << " M sales/s into three windows, "
+         << queryTime / checks * 1e6 << " us per top-" << K << " query" << endl;
+    cout << checks << " checks against recomputing the window: " << mismatches << " mismatches" << endl;
+    cout << "tracked salespeople: minute " << live.minute.activeSellers() << ", hour "
+         << live.hour.activeSellers() << ", day " << live.day.activeSellers() << endl;
+    cout << "Top of the last day:" << endl;
+    for (const Ranking& r : live.day.top())
+        cout << "  #" << r.salesId << "  $" << r.cents / 100 << endl;
+    return 0;
+}
@@ -1,6 +1,7 @@
 // customer_scope_resolution.cpp
 #include <iostream>
 #include <string>
+#include <utility>
 using namespace std;
 
 class Customer {
@@ -10,18 +11,19 @@ private:
 public:
     void setName(string n);
     void setBalance(double b);
-    string getName();
-    double getBalance();
+    const string& getName() const;
+    double getBalance() const;
 };
 
 void Customer::setName(string n) { name = std::move(n); }
 void Customer::setBalance(double b) { balance = b; }
-string Customer::getName() { return name; }
-double Customer::getBalance() { return balance; }
+const string& Customer::getName() const { return name; }
+double Customer::getBalance() const { return balance; }
 
 int main() {
     Customer c;
     c.setName("Aisha");
     c.setBalance(120.50);
     cout << c.getName() << " has $" << c.getBalance() << "\n";
+    return 0;
 }
@@ -0,0 +1,442 @@
+// This code builds salary arithmetic on Employees as lazy expression trees
+// (expression templates), evaluated in one pass.
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <stdexcept>
+#include <type_traits>
+#include <cmath>
+#include <cstring>
+#include <cstddef>
+#if defined(__x86_64__) || defined(__i386__)
+#define HAVE_X86_KERNELS 1
+#endif
+using namespace std;
+
+// ------------------------------------------------------------
+// How it works
+// a + b - c + 50.0 no longer computes anything by itself: each
+// operator returns a small node (Plus, Minus) that holds its
+// operands, so the whole expression becomes one object whose
+// type is the tree. Evaluating it walks the tree once:
+//  - as a number: double d = a + b - c + 50.0;
+//  - into an Employee: Employee e = a + 50.0; (e keeps a's id)
+//  - over whole EmployeeArrays: pay = base + bonus - tax + 50.0;
+//    computes every element in a single fused loop, 4 salaries
+//    per step with AVX2 (2 otherwise), with no temporary arrays
+//  - sum(...) adds up an array expression, or a vector<Employee>,
+//    and is itself a number that can be used in more arithmetic
+// Employees and arrays are held by reference inside a tree, so a
+// tree must not outlive them; numbers are held by value. Arrays
+// in one expression must have the same length (length_error).
+// ------------------------------------------------------------
+
+// Two or four doubles at once, in whatever registers the target has
+typedef double Vec2 __attribute__((vector_size(16)));
+typedef double Vec4 __attribute__((vector_size(32)));
+
+// Every node and leaf derives from SalaryExpr<itself>
+template <typename E>
+struct SalaryExpr {
+    const E& self() const { return static_cast<const E&>(*this); }
+};
+
+// leaves are stored by reference, nodes and numbers by value
+template <typename E>
+using Operand = conditional_t<E::isLeaf, const E&, E>;
+
+// ------------------------------------------------------------
+// Class: Employee (from demo-3-4)
+// One salary. In an array expression it stands for the same
+// salary in every row.
+// ------------------------------------------------------------
+class Employee : public SalaryExpr<Employee> {
+private:
+    int    idNum;    // e.g., 1234
+    double salary;   // e.g., 400.00
+
+public:
+    static const bool isLeaf = true;
+
+    Employee(int id = 0, double sal = 0.0) : idNum(id), salary(sal) {}
+
+    // Employee e = <expression>: e takes the first employee's id
+    template <typename E>
+    Employee(const SalaryExpr<E>& e) : idNum(e.self().firstId()), salary(e.self().value()) {}
+
+    // e = <expression>: e keeps its own id
+    template <typename E>
+    Employee& operator=(const SalaryExpr<E>& e) {
+        salary = e.self().value();
+        return *this;
+    }
+
+    double value() const { return salary; }
+    int firstId() const { return idNum; }
+    size_t size() const { return 0; }
+    template <typename V>
+    void at(size_t, V& v) const { v = V{} + salary; }
+
+    int getId() const { return idNum; }
+    double getSalary() const { return salary; }
+    void print(const string& label = "") const {
+        if (!label.empty()) cout << label << ": ";
+        cout << "Employee #" << idNum << " with salary $" << salary << '\n';
+    }
+};
+
+// ------------------------------------------------------------
+// Leaf: a plain amount of money, e.g. a raise
+// ------------------------------------------------------------
+struct Amount : SalaryExpr<Amount> {
+    static const bool isLeaf = false;
+    double amount;
+    explicit Amount(double a) : amount(a) {}
+    double value() const { return amount; }
+    int firstId() const { return 0; }
+    size_t size() const { return 0; }
+    template <typename V>
+    void at(size_t, V& v) const { v = V{} + amount; }
+};
+
+// ------------------------------------------------------------
+// Nodes: L + R and L - R
+// ------------------------------------------------------------
+template <typename L, typename R, bool subtract>
+struct Combine : SalaryExpr<Combine<L, R, subtract>> {
+    static const bool isLeaf = false;
+    Operand<L> l;
+    Operand<R> r;
+    Combine(const L& l, const R& r) : l(l), r(r) {
+        if (l.size() && r.size() && l.size() != r.size())
+            throw length_error("array expression of a different length");
+    }
+
+    double value() const { return subtract ? l.value() - r.value() : l.value() + r.value(); }
+    operator double() const { return value(); }
+    int firstId() const { return l.firstId() ? l.firstId() : r.firstId(); }
+    size_t size() const { return l.size() ? l.size() : r.size(); }
+    template <typename V>
+    void at(size_t i, V& v) const {
+        V a, b;
+        l.at(i, a);
+        r.at(i, b);
+        v = subtract ? a - b : a + b;
+    }
+};
+template <typename L, typename R> using Plus = Combine<L, R, false>;
+template <typename L, typename R> using Minus = Combine<L, R, true>;
+
+template <typename L, typename R>
+Plus<L, R> operator+(const SalaryExpr<L>& l, const SalaryExpr<R>& r) { return Plus<L, R>(l.self(), r.self()); }
+template <typename L, typename R>
+Minus<L, R> operator-(const SalaryExpr<L>& l, const SalaryExpr<R>& r) { return Minus<L, R>(l.self(), r.self()); }
+template <typename L>
+Plus<L, Amount> operator+(const SalaryExpr<L>& l, double raise) { return Plus<L, Amount>(l.self(), Amount(raise)); }
+template <typename R>
+Plus<Amount, R> operator+(double raise, const SalaryExpr<R>& r) { return Plus<Amount, R>(Amount(raise), r.self()); }
+template <typename L>
+Minus<L, Amount> operator-(const SalaryExpr<L>& l, double cut) { return Minus<L, Amount>(l.self(), Amount(cut)); }
+template <typename R>
+Minus<Amount, R> operator-(double base, const SalaryExpr<R>& r) { return Minus<Amount, R>(Amount(base), r.self()); }
+
+// ------------------------------------------------------------
+// Fused evaluation loops, compiled once for AVX2 and once for
+// two doubles at a time (SSE2 on every x86-64); the nodes
+// inline into both.
+// ------------------------------------------------------------
+template <typename V, typename E>
+inline __attribute__((always_inline)) void fusedStore(const E& e, double* out, size_t n) {
+    const size_t lanes = sizeof(V) / sizeof(double);
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes) {
+        V v;
+        e.at(i, v);
+        memcpy(out + i, &v, sizeof(V));
+    }
+    for (; i < n; ++i) {
+        double d;
+        e.at(i, d);
+        out[i] = d;
+    }
+}
+
+template <typename V, typename E>
+inline __attribute__((always_inline)) double fusedSum(const E& e, size_t n) {
+    const size_t lanes = sizeof(V) / sizeof(double);
+    V acc0 = V{}, acc1 = V{};   // two chains keep two adds in flight
+    size_t i = 0;
+    for (; i + 2 * lanes <= n; i += 2 * lanes) {
+        V a, b;
+        e.at(i, a);
+        e.at(i + lanes, b);
+        acc0 += a;
+        acc1 += b;
+    }
+    acc0 += acc1;
+    double total = 0.0;
+    for (size_t k = 0; k < lanes; ++k) total += acc0[k];
+    for (; i < n; ++i) {
+        double d;
+        e.at(i, d);
+        total += d;
+    }
+    return total;
+}
+
+bool cpuHasAvx2() {
+#ifdef HAVE_X86_KERNELS
+    __builtin_cpu_init();   // this runs from a static initializer
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+bool useAvx2 = cpuHasAvx2();   // the benchmark turns it off to compare
+
+#ifdef HAVE_X86_KERNELS
+template <typename E>
+__attribute__((target("avx2"))) void storeAvx2(const E& e, double* out, size_t n) { fusedStore<Vec4>(e, out, n); }
+template <typename E>
+__attribute__((target("avx2"))) double sumAvx2(const E& e, size_t n) { return fusedSum<Vec4>(e, n); }
+#endif
+
+template <typename E>
+void storeFused(const E& e, double* out, size_t n) {
+#ifdef HAVE_X86_KERNELS
+    if (useAvx2) return storeAvx2(e, out, n);
+#endif
+    fusedStore<Vec2>(e, out, n);
+}
+template <typename E>
+double sumFused(const E& e, size_t n) {
+#ifdef HAVE_X86_KERNELS
+    if (useAvx2) return sumAvx2(e, n);
+#endif
+    return fusedSum<Vec2>(e, n);
+}
+
+// ------------------------------------------------------------
+// Class: EmployeeArray
+// Many employees as two columns (ids, salaries), so an array
+// expression can load several salaries at once.
+// ------------------------------------------------------------
+class EmployeeArray : public SalaryExpr<EmployeeArray> {
+private:
+    vector<int> ids;
+    vector<double> salaries;
+
+public:
+    static const bool isLeaf = true;
+
+    EmployeeArray() = default;
+    explicit EmployeeArray(const vector<Employee>& staff) {
+        for (const Employee& e : staff) push_back(e);
+    }
+    void push_back(const Employee& e) {
+        ids.push_back(e.getId());
+        salaries.push_back(e.getSalary());
+    }
+
+    // pay = <array expression>: one fused pass, no temporaries. The
+    // expression may use this array itself (pay = pay + 50.0).
+    template <typename E>
+    EmployeeArray& operator=(const SalaryExpr<E>& e) {
+        if (e.self().size() != size()) throw length_error("array expression of a different length");
+        storeFused(e.self(), salaries.data(), size());
+        return *this;
+    }
+
+    size_t size() const { return salaries.size(); }
+    int firstId() const { return ids.empty() ? 0 : ids[0]; }
+    template <typename V>
+    void at(size_t i, V& v) const { memcpy(&v, salaries.data() + i, sizeof(V)); }
+
+    Employee operator[](size_t i) const { return Employee(ids[i], salaries[i]); }
+    const double* salaryData() const { return salaries.data(); }
+};
+
+// ------------------------------------------------------------
+// sum(array expression) and sum(vector<Employee>): lazy totals
+// ------------------------------------------------------------
+// The total is worked out the first time it is needed and then
+// kept, so inside an array expression it costs one pass, not one
+// per row, and pay = pay + sum(pay) adds the sum from before the
+// store to every row.
+template <typename E>
+struct SumOf : SalaryExpr<SumOf<E>> {
+    static const bool isLeaf = false;
+    Operand<E> e;
+    mutable double total{};
+    mutable bool known{false};
+    explicit SumOf(const E& e) : e(e) {}
+    double value() const {
+        if (!known) {
+            total = sumFused(e, e.size());
+            known = true;
+        }
+        return total;
+    }
+    operator double() const { return value(); }
+    int firstId() const { return 0; }
+    size_t size() const { return 0; }
+    template <typename V>
+    void at(size_t, V& v) const { v = V{} + value(); }
+};
+
+struct SumOfStaff : SalaryExpr<SumOfStaff> {
+    static const bool isLeaf = false;
+    const vector<Employee>* staff;
+    mutable double total{};
+    mutable bool known{false};
+    explicit SumOfStaff(const vector<Employee>& s) : staff(&s) {}
+    double value() const {
+        if (known) return total;
+        double a = 0, b = 0;   // two chains: the employees sit 16 bytes apart
+        size_t i = 0, n = staff->size();
+        for (; i + 2 <= n; i += 2) {
+            a += (*staff)[i].getSalary();
+            b += (*staff)[i + 1].getSalary();
+        }
+        if (i < n) a += (*staff)[i].getSalary();
+        total = a + b;
+        known = true;
+        return total;
+    }
+    operator double() const { return value(); }
+    int firstId() const { return 0; }
+    size_t size() const { return 0; }
+    template <typename V>
+    void at(size_t, V& v) const { v = V{} + value(); }
+};
+
+template <typename E>
+SumOf<E> sum(const SalaryExpr<E>& e) { return SumOf<E>(e.self()); }
+inline SumOfStaff sum(const vector<Employee>& staff) { return SumOfStaff(staff); }
+
+// ------------------------------------------------------------
+// demo-3-4's Employee, unchanged, for the benchmark
+// ------------------------------------------------------------
+class EagerEmployee {
+private:
+    int    idNum;
+    double salary;
+public:
+    EagerEmployee(int id = 0, double sal = 0.0) : idNum(id), salary(sal) {}
+    double operator+(const EagerEmployee& rhs) const { return salary + rhs.salary; }
+    double operator-(const EagerEmployee& rhs) const { return salary - rhs.salary; }
+    EagerEmployee operator+(double raise) const {
+        EagerEmployee tmp = *this;
+        tmp.salary = salary + raise;
+        return tmp;
+    }
+    double getSalary() const { return salary; }
+};
+
+double seconds(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// ---------------------------- Demo (main) ----------------------------
+int main() {
+    Employee aClerk(1234, 400.00);
+    aClerk.print("Initial aClerk");
+    aClerk = aClerk + 50.00;                 // evaluated once, into aClerk
+    aClerk.print("After $50 raise (aClerk = aClerk + 50)");
+    Employee anotherClerk = aClerk + 50.00;  // takes aClerk's id, as in demo-3-4
+    anotherClerk.print("anotherClerk");
+    Employee oneEmp(2222, 14.55);
+    double newSalary = 2.33 + oneEmp;
+    cout << "2.33 + oneEmp.salary = $" << newSalary << '\n';
+    double sumSalaries = aClerk + anotherClerk;
+    double diffSalaries = anotherClerk - aClerk;
+    cout << "Sum of aClerk and anotherClerk salaries = $" << sumSalaries << '\n';
+    cout << "Difference (anotherClerk - aClerk)      = $" << diffSalaries << '\n';
+    vector<Employee> staff = { aClerk, anotherClerk, oneEmp };
+    cout << "Payroll plus a $100 bonus pool          = $" << double(sum(staff) + 100.0) << '\n';
+
+    // sum(pay) is taken once, before pay is overwritten: every salary becomes 1 + 8
+    EmployeeArray eight, shortArray;
+    for (int x = 0; x < 8; ++x) eight.push_back(Employee(x, 1.0));
+    eight = eight + sum(eight);
+    bool allNine = true;
+    for (size_t x = 0; x < eight.size(); ++x) allNine = allNine && eight.salaryData()[x] == 9.0;
+    shortArray.push_back(Employee(1, 1.0));
+    bool rejected = false;
+    try {
+        eight = eight + shortArray;
+    } catch (const length_error&) {
+        rejected = true;
+    }
+    cout << "pay = pay + sum(pay) on eight $1 salaries: " << (allNine ? "all $9" : "WRONG")
+         << "; adding a shorter array " << (rejected ? "throws length_error" : "WAS ACCEPTED") << '\n';
+
+    // ---- pay = base + bonus - tax + 50 over 4 * 10^6 employees, 10 times ----
+    const size_t N = 4000000;
+    const int ROUNDS = 10;
+    mt19937 rng(12);
+    uniform_real_distribution<double> money(100.0, 5000.0);
+    vector<EagerEmployee> eBase, eBonus, eTax;
+    EmployeeArray base, bonus, tax, pay;
+    for (size_t x = 0; x < N; ++x) {
+        double b = money(rng), o = money(rng) / 10, t = money(rng) / 5;
+        eBase.emplace_back(int(x), b);
+        eBonus.emplace_back(int(x), o);
+        eTax.emplace_back(int(x), t);
+        base.push_back(Employee(int(x), b));
+        bonus.push_back(Employee(int(x), o));
+        tax.push_back(Employee(int(x), t));
+        pay.push_back(Employee(int(x), 0.0));
+    }
+
+    cout << fixed << setprecision(1) << endl;
+    vector<double> eagerPay(N);
+    auto t = chrono::steady_clock::now();
+    for (int r = 0; r < ROUNDS; ++r)
+        for (size_t x = 0; x < N; ++x)   // demo-3-4's operators, one employee at a time
+            eagerPay[x] = (eBase[x] + 50.0) + eBonus[x] - eTax[x].getSalary();
+    double eagerSec = seconds(t);
+
+    // one pass per operator, with a temporary array after every step
+    vector<double> step1(N), step2(N), stepPay(N);
+    t = chrono::steady_clock::now();
+    for (int r = 0; r < ROUNDS; ++r) {
+        for (size_t x = 0; x < N; ++x) step1[x] = base.salaryData()[x] + bonus.salaryData()[x];
+        for (size_t x = 0; x < N; ++x) step2[x] = step1[x] - tax.salaryData()[x];
+        for (size_t x = 0; x < N; ++x) stepPay[x] = step2[x] + 50.0;
+    }
+    double stepSec = seconds(t);
+
+    double fusedSec[2] = { 0, 0 };
+    bool avx2 = useAvx2;
+    for (int simd = 0; simd < (avx2 ? 2 : 1); ++simd) {
+        useAvx2 = simd == 1;
+        t = chrono::steady_clock::now();
+        for (int r = 0; r < ROUNDS; ++r) pay = base + bonus - tax + 50.0;
+        fusedSec[simd] = seconds(t);
+    }
+    useAvx2 = avx2;
+
+    bool same = true;
+    for (size_t x = 0; x < N && same; ++x)
+        same = pay.salaryData()[x] == stepPay[x] && fabs(pay.salaryData()[x] - eagerPay[x]) < 1e-9;
+    double perRound = double(N) * ROUNDS / 1e6;
+    cout << "demo-3-4 operators, per employee: " << perRound / eagerSec << " M employees/s" << endl;
+    cout << "a temporary array per operator:   " << perRound / stepSec << " M employees/s" << endl;
+    cout << "fused expression, 2 at a time:    " << perRound / fusedSec[0] << " M employees/s" << endl;
+    if (avx2)
+        cout << "fused expression, AVX2:           " << perRound / fusedSec[1] << " M employees/s" << endl;
+    cout << "results " << (same ? "agree" : "DIFFER") << endl;
+
+    t = chrono::steady_clock::now();
+    double total = sum(base + bonus - tax);
+    double sumSec = seconds(t);
+    double check = 0;
+    for (size_t x = 0; x < N; ++x) check += base.salaryData()[x] + bonus.salaryData()[x] - tax.salaryData()[x];
+    cout << setprecision(2) << "sum(base + bonus - tax) = $" << total << " in " << sumSec * 1e3
+         << " ms (one pass; a plain loop gives $" << check << ")" << endl;
+    return 0;
+}
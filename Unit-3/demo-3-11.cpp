@@ -0,0 +1,214 @@
+// This code totals demo-3-5's Sales exactly, in whole cents, and in parallel.
+//
+//   ./demo-3-11 [sales]    benchmark (default 5 * 10^7 sales)
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+using namespace std;
+
+class SaleAccumulator;
+
+// ---------------------------------------------------
+// Class Sale: represents a single sales transaction
+// Adding two Sales now gives a SaleAccumulator instead
+// of a Sale #999 with a double amount, so
+//     SaleAccumulator total = aShirt + aTie + pants;
+// still reads the same but adds exact cents.
+// ---------------------------------------------------
+class Sale {
+private:
+    int receiptNum;       // Unique receipt number for the sale
+    double saleAmount;    // Sale amount in dollars
+
+public:
+    Sale(int num = 0, double sale = 0.0) : receiptNum(num), saleAmount(sale) {}
+
+    SaleAccumulator operator+(const Sale&) const;
+
+    int64_t cents() const { return llround(saleAmount * 100.0); }
+    void showSale() const {
+        cout << "Sale #" << receiptNum << " for $" << saleAmount << endl;
+    }
+};
+
+// ---------------------------------------------------
+// Class SaleAccumulator: a running total in whole cents
+// and the number of sales in it. Integer cents add up
+// exactly, in any order, so a parallel total is always
+// bit-identical to a serial one. int64 cents hold about
+// $92 quadrillion, far beyond 10^9 sales a day.
+// ---------------------------------------------------
+class SaleAccumulator {
+private:
+    int64_t totalCents{};
+    uint64_t sales{};
+
+public:
+    SaleAccumulator() = default;
+    SaleAccumulator(int64_t cents, uint64_t count) : totalCents(cents), sales(count) {}
+
+    SaleAccumulator& operator+=(const Sale& s) {
+        totalCents += s.cents();
+        ++sales;
+        return *this;
+    }
+    SaleAccumulator& operator+=(const SaleAccumulator& a) {
+        totalCents += a.totalCents;
+        sales += a.sales;
+        return *this;
+    }
+    SaleAccumulator operator+(const Sale& s) const { return SaleAccumulator(*this) += s; }
+    SaleAccumulator operator+(const SaleAccumulator& a) const { return SaleAccumulator(*this) += a; }
+    bool operator==(const SaleAccumulator& a) const { return totalCents == a.totalCents && sales == a.sales; }
+
+    int64_t cents() const { return totalCents; }
+    uint64_t count() const { return sales; }
+    void showTotal() const {
+        int64_t c = llabs(totalCents);
+        cout << sales << " sales for " << (totalCents < 0 ? "-$" : "$") << c / 100 << "."
+             << setw(2) << setfill('0') << c % 100 << setfill(' ') << endl;
+    }
+
+    // Totals a whole array: each thread sums a contiguous run of fixed-size
+    // blocks, one partial per block, and the partials are combined pairwise
+    // in a fixed tree, so the work split never depends on the thread count.
+    static SaleAccumulator sum(const Sale* s, size_t n, unsigned threads) {
+        return reduce(n, threads, [s](size_t first, size_t last) {
+            int64_t a = 0, b = 0;   // two chains: llround is the slow part
+            size_t x = first;
+            for (; x + 2 <= last; x += 2) {
+                a += s[x].cents();
+                b += s[x + 1].cents();
+            }
+            if (x < last) a += s[x].cents();
+            return a + b;
+        });
+    }
+    // the same over a column of amounts already in cents
+    static SaleAccumulator sum(const int64_t* cents, size_t n, unsigned threads) {
+        return reduce(n, threads, [cents](size_t first, size_t last) {
+            int64_t a = 0, b = 0, c = 0, d = 0;
+            size_t x = first;
+            for (; x + 4 <= last; x += 4) {
+                a += cents[x];
+                b += cents[x + 1];
+                c += cents[x + 2];
+                d += cents[x + 3];
+            }
+            for (; x < last; ++x) a += cents[x];
+            return (a + b) + (c + d);
+        });
+    }
+
+private:
+    static const size_t BLOCK = 1 << 16;
+
+    template <typename F>
+    static SaleAccumulator reduce(size_t n, unsigned threads, F sumBlock) {
+        const size_t blocks = (n + BLOCK - 1) / BLOCK;
+        if (blocks == 0) return SaleAccumulator();
+        threads = unsigned(min<size_t>(max(1u, threads), blocks));
+        vector<SaleAccumulator> partial(blocks);
+        auto work = [&](unsigned w) {
+            for (size_t b = blocks * w / threads; b < blocks * (w + 1) / threads; ++b) {
+                size_t first = b * BLOCK, last = min(n, first + BLOCK);
+                partial[b] = SaleAccumulator(sumBlock(first, last), last - first);
+            }
+        };
+        vector<thread> pool;
+        for (unsigned w = 1; w < threads; ++w) pool.emplace_back(work, w);
+        work(0);
+        for (thread& t : pool) t.join();
+        // pairwise tree over the blocks: (0+1) + (2+3), then ((0+1)+(2+3)) + ...
+        for (size_t step = 1; step < blocks; step *= 2)
+            for (size_t b = 0; b + step < blocks; b += 2 * step) partial[b] += partial[b + step];
+        return partial[0];
+    }
+};
+
+SaleAccumulator Sale::operator+(const Sale& other) const {
+    return SaleAccumulator() + *this + other;
+}
+
+// ---------------------------------------------------
+// demo-3-5's Sale, for the benchmark: every + makes a
+// temporary Sale #999 and adds double dollars
+// ---------------------------------------------------
+class ChainedSale {
+private:
+    int receiptNum;
+    double saleAmount;
+public:
+    ChainedSale(int num = 0, double sale = 0.0) : receiptNum(num), saleAmount(sale) {}
+    ChainedSale operator+(ChainedSale transaction) {
+        ChainedSale temp(999, 0.0);
+        temp.saleAmount = saleAmount + transaction.saleAmount;
+        return temp;
+    }
+    double getAmount() const { return saleAmount; }
+};
+
+double seconds(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// ---------------- Main Program ----------------
+int main(int argc, char* argv[]) {
+    Sale aShirt(1567, 39.95);   // Shirt purchase
+    Sale aTie(1568, 33.55);     // Tie purchase
+    Sale pants(1569, 49.99);    // Pants purchase
+    SaleAccumulator total = aShirt + aTie + pants;
+    total.showTotal();
+
+    // ---- 5 * 10^7 sales of $0.01 to $999.99 ----
+    const size_t N = argc > 1 ? strtoull(argv[1], nullptr, 10) : 50000000;
+    mt19937_64 rng(13);
+    vector<Sale> sales;
+    vector<ChainedSale> chained;
+    vector<int64_t> cents;
+    sales.reserve(N);
+    chained.reserve(N);
+    cents.reserve(N);
+    for (size_t x = 0; x < N; ++x) {
+        int64_t c = int64_t(rng() % 99999) + 1;
+        sales.emplace_back(int(x), c / 100.0);
+        chained.emplace_back(int(x), c / 100.0);
+        cents.push_back(c);
+    }
+
+    cout << endl << fixed << setprecision(1) << N << " sales, " << thread::hardware_concurrency()
+         << " hardware threads" << endl;
+    auto t = chrono::steady_clock::now();
+    ChainedSale chainTotal(0, 0.0);
+    for (ChainedSale& s : chained) chainTotal = chainTotal + s;
+    double chainSec = seconds(t);
+
+    SaleAccumulator serial;
+    for (const Sale& s : sales) serial += s;
+
+    cout << "chained operator+:         " << N / chainSec / 1e6 << " M sales/s, $"
+         << setprecision(2) << chainTotal.getAmount() << endl;
+    for (unsigned threads = 1; threads <= 8; threads *= 2) {
+        t = chrono::steady_clock::now();
+        SaleAccumulator fromSales = SaleAccumulator::sum(sales.data(), N, threads);
+        double salesSec = seconds(t);
+        t = chrono::steady_clock::now();
+        SaleAccumulator fromCents = SaleAccumulator::sum(cents.data(), N, threads);
+        double centsSec = seconds(t);
+        cout << setprecision(1) << "SaleAccumulator, " << threads << " thread" << (threads == 1 ? ": " : "s:")
+             << "  " << N / salesSec / 1e6 << " M sales/s from Sales, " << N / centsSec / 1e6
+             << " M sales/s from a cents column, "
+             << (fromSales == serial && fromCents == serial ? "bit-identical" : "DIFFERENT") << endl;
+    }
+    cout << "exact total: ";
+    serial.showTotal();
+    cout << setprecision(6) << "chained double drift: $" << chainTotal.getAmount() - serial.cents() / 100.0 << endl;
+    return 0;
+}
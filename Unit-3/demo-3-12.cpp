@@ -0,0 +1,270 @@
+// This code gives demo-3-6's Classroom O(1) moves and a copy-on-write roster.
+//
+//   ./demo-3-12 [classrooms]    benchmark (default 10^5 classrooms of 40)
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <utility>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+using namespace std;
+
+// -------------------------------------------------
+// Class: Roster
+// The student names, shared by every Classroom that
+// was copied from the same one. refs counts those
+// classrooms; the last one to let go deletes it.
+// -------------------------------------------------
+class Roster {
+    friend class Classroom;
+
+private:
+    atomic<int> refs{1};
+    string* student;   // Dynamic array to store student names
+    int numStudents;   // Number of students in it
+    int capacity;      // Number of names the array has room for
+
+    explicit Roster(int room) : student(new string[room]), numStudents(0), capacity(room) {}
+    ~Roster() { delete[] student; }
+    Roster(const Roster&) = delete;
+    Roster& operator=(const Roster&) = delete;
+
+    void addRef() { refs.fetch_add(1, memory_order_relaxed); }
+    static void release(Roster* r) {
+        if (r && r->refs.fetch_sub(1, memory_order_acq_rel) == 1) delete r;
+    }
+};
+
+// -------------------------------------------------
+// Class: Classroom
+// Copying a Classroom (constructor or operator=) only
+// shares the roster and bumps its count. Moving one
+// takes the roster pointer and leaves the source with
+// an empty class. The first change to a shared roster
+// copies it, so the other classrooms never see it.
+// -------------------------------------------------
+class Classroom {
+private:
+    Roster* roster;    // nullptr for a class with no students
+    int gradeLevel;    // Grade level of this classroom
+
+public:
+    Classroom(int grade = 0) : roster(nullptr), gradeLevel(grade) {}
+    Classroom(int grade, const vector<string>& names);
+    Classroom(const Classroom& other) : roster(other.roster), gradeLevel(other.gradeLevel) {
+        if (roster) roster->addRef();
+    }
+    Classroom(Classroom&& other) noexcept : roster(other.roster), gradeLevel(other.gradeLevel) {
+        other.roster = nullptr;
+    }
+    ~Classroom() { Roster::release(roster); }
+
+    Classroom& operator=(const Classroom&);
+    Classroom& operator=(Classroom&&) noexcept;
+
+    int getGradeLevel() const { return gradeLevel; }
+    int size() const { return roster ? roster->numStudents : 0; }
+    const string& getStudent(int x) const { return roster->student[x]; }
+    bool sharesRosterWith(const Classroom& other) const { return roster && roster == other.roster; }
+
+    void setStudent(int x, const string& name);
+    void addStudent(const string& name);
+    void display() const;
+
+private:
+    void makeUnique(int room);
+};
+
+Classroom::Classroom(int grade, const vector<string>& names) : roster(nullptr), gradeLevel(grade) {
+    if (names.empty()) return;
+    roster = new Roster(int(names.size()));
+    for (const string& name : names) roster->student[roster->numStudents++] = name;
+}
+
+// -------------------------------------------------
+// Assignment Operators
+// Take a reference to the new roster before dropping
+// the old one, so self-assignment is safe without a
+// special case.
+// -------------------------------------------------
+Classroom& Classroom::operator=(const Classroom& aClassroom) {
+    if (aClassroom.roster) aClassroom.roster->addRef();
+    Roster::release(roster);
+    roster = aClassroom.roster;
+    gradeLevel = aClassroom.gradeLevel;
+    return *this;
+}
+
+Classroom& Classroom::operator=(Classroom&& aClassroom) noexcept {
+    if (this != &aClassroom) {
+        Roster::release(roster);
+        roster = aClassroom.roster;
+        gradeLevel = aClassroom.gradeLevel;
+        aClassroom.roster = nullptr;
+    }
+    return *this;
+}
+
+// -------------------------------------------------
+// makeUnique(): gives this classroom its own roster
+// with room for at least `room` names, copying the
+// names only if another classroom still shares it
+// -------------------------------------------------
+void Classroom::makeUnique(int room) {
+    if (roster && roster->refs.load(memory_order_acquire) == 1 && roster->capacity >= room) return;
+    Roster* own = new Roster(max(room, size()));
+    bool shared = roster && roster->refs.load(memory_order_acquire) > 1;
+    for (int x = 0; x < size(); ++x) {
+        if (shared) own->student[x] = roster->student[x];
+        else own->student[x] = std::move(roster->student[x]);
+    }
+    own->numStudents = size();
+    Roster::release(roster);
+    roster = own;
+}
+
+void Classroom::setStudent(int x, const string& name) {
+    makeUnique(size());
+    roster->student[x] = name;
+}
+
+void Classroom::addStudent(const string& name) {
+    int n = size();
+    makeUnique(roster && n < roster->capacity ? n + 1 : max(4, 2 * n));
+    roster->student[roster->numStudents++] = name;
+}
+
+// -------------------------------------------------
+// display(): prints out grade level and all student names
+// -------------------------------------------------
+void Classroom::display() const {
+    cout << "Grade " << gradeLevel << " class list:" << endl;
+    for (int x = 0; x < size(); x++) {
+        cout << roster->student[x] << endl;
+    }
+}
+
+// -------------------------------------------------
+// demo-3-6's Classroom, for the benchmark: every
+// assignment deletes and reallocates the array and
+// copies each name
+// -------------------------------------------------
+class DeepClassroom {
+private:
+    string* student;
+    int numStudents;
+    int gradeLevel;
+
+public:
+    DeepClassroom(int grade, const vector<string>& names)
+        : student(new string[names.size()]), numStudents(int(names.size())), gradeLevel(grade) {
+        for (int x = 0; x < numStudents; x++) student[x] = names[x];
+    }
+    ~DeepClassroom() { delete[] student; }
+    // only so a vector can hold them; the benchmark never moves one
+    DeepClassroom(DeepClassroom&& other) noexcept
+        : student(other.student), numStudents(other.numStudents), gradeLevel(other.gradeLevel) {
+        other.student = nullptr;
+        other.numStudents = 0;
+    }
+    DeepClassroom& operator=(DeepClassroom& aClassroom) {
+        gradeLevel = aClassroom.gradeLevel;
+        numStudents = aClassroom.numStudents;
+        delete[] student;
+        student = new string[numStudents];
+        for (int x = 0; x < numStudents; x++) student[x] = aClassroom.student[x];
+        return *this;
+    }
+    void setStudent(int x, const string& name) { student[x] = name; }
+};
+
+double seconds(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// -------------------------------------------------
+// Main Program
+// -------------------------------------------------
+int main(int argc, char* argv[]) {
+    Classroom oneClass(3, { "Ana", "Bashir", "Chen" });
+    {
+        Classroom anotherClass(4, { "Dara", "Emeka" });
+        oneClass = anotherClass;   // shares anotherClass's roster
+        cout << "After assignment the classrooms share a roster: "
+             << (oneClass.sharesRosterWith(anotherClass) ? "yes" : "no") << endl;
+        anotherClass.addStudent("Farida");   // anotherClass gets its own copy first
+        cout << "After anotherClass adds a student: "
+             << (oneClass.sharesRosterWith(anotherClass) ? "yes" : "no") << endl;
+        anotherClass.display();
+    } // <- anotherClass goes out of scope here
+    oneClass = oneClass;
+    cout << endl << "After the second class has gone out of scope:" << endl;
+    oneClass.display();
+
+    // ---- 10^5 classrooms of 40 students ----
+    const size_t N = argc > 1 ? strtoull(argv[1], nullptr, 10) : 100000;
+    const int STUDENTS = 40;
+    const char* first[] = { "Alexandra", "Benedict", "Catalina", "Dmitri", "Evangeline", "Francesca",
+                            "Gwendolyn", "Harrison" };
+    const char* last[] = { "Abernathy", "Blackwood", "Castellanos", "Delacroix", "Everhart",
+                           "Fitzgerald", "Grimaldi", "Hollingsworth" };
+    mt19937_64 rng(14);
+    vector<Classroom> from, to;
+    vector<DeepClassroom> deepFrom, deepTo;
+    from.reserve(N);
+    to.reserve(N);
+    deepFrom.reserve(N);
+    deepTo.reserve(N);
+    vector<string> names(STUDENTS);
+    for (size_t c = 0; c < N; ++c) {
+        for (string& name : names) name = string(first[rng() % 8]) + " " + last[rng() % 8];
+        from.emplace_back(int(c % 12) + 1, names);
+        deepFrom.emplace_back(int(c % 12) + 1, names);
+        to.emplace_back(int(c % 12) + 1, names);        // the targets start out full, as in demo-3-6
+        deepTo.emplace_back(int(c % 12) + 1, names);
+    }
+
+    cout << endl << fixed << setprecision(1) << N << " classrooms of " << STUDENTS << " students" << endl;
+    auto t = chrono::steady_clock::now();
+    for (size_t c = 0; c < N; ++c) deepTo[c] = deepFrom[c];
+    double deepSec = seconds(t);
+    t = chrono::steady_clock::now();
+    for (size_t c = 0; c < N; ++c) to[c] = from[c];
+    double shareSec = seconds(t);
+    t = chrono::steady_clock::now();
+    for (size_t c = 0; c < N; ++c) to[c] = from[c];   // again: nothing to free this time
+    double bumpSec = seconds(t);
+    bool same = true;
+    for (size_t c = 0; c < N && same; ++c) same = to[c].sharesRosterWith(from[c]);
+
+    // the copy now happens on the first change, and only once
+    t = chrono::steady_clock::now();
+    for (size_t c = 0; c < N; ++c) to[c].setStudent(0, "New Student");
+    double writeSec = seconds(t);
+    t = chrono::steady_clock::now();
+    for (size_t c = 0; c < N; ++c) deepTo[c].setStudent(0, "New Student");
+    double deepWriteSec = seconds(t);
+    for (size_t c = 0; c < N && same; ++c)
+        same = !to[c].sharesRosterWith(from[c]) && to[c].getStudent(0) == "New Student" &&
+               from[c].getStudent(0) != "New Student" && to[c].getStudent(1) == from[c].getStudent(1);
+
+    vector<Classroom> moved(N);
+    t = chrono::steady_clock::now();
+    for (size_t c = 0; c < N; ++c) moved[c] = std::move(to[c]);
+    double moveSec = seconds(t);
+    for (size_t c = 0; c < N && same; ++c) same = to[c].size() == 0 && moved[c].size() == STUDENTS;
+
+    cout << "deep-copy operator=:             " << deepSec / N * 1e9 << " ns per assignment" << endl;
+    cout << "copy-on-write, freeing old names: " << shareSec / N * 1e9 << " ns per assignment ("
+         << deepSec / shareSec << "x)" << endl;
+    cout << "copy-on-write, count bump only:   " << bumpSec / N * 1e9 << " ns per assignment ("
+         << deepSec / bumpSec << "x)" << endl;
+    cout << "move assignment:                 " << moveSec / N * 1e9 << " ns per assignment" << endl;
+    cout << "first change after a shared assignment: " << writeSec / N * 1e9 << " ns (deep copy "
+         << deepWriteSec / N * 1e9 << " ns); rosters " << (same ? "correct" : "WRONG") << endl;
+    return 0;
+}
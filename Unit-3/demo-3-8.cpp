@@ -0,0 +1,341 @@
+// This code renders Customer statement lines in bulk, without iostream.
+//
+//   ./demo-3-8 [file]    benchmark, writing to file (default /dev/null)
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+using namespace std;
+
+// --------------------------------------------------
+// Class: Customer
+// The Customer from demo-3-1. The report writer is a
+// friend too, so it can read the private members
+// directly.
+// --------------------------------------------------
+class Customer {
+    friend void displayAsAFriend(Customer);
+    friend class CustomerReport;
+
+private:
+    int custNum;        // Private data member: customer number
+    double balanceDue;  // Private data member: balance due for the customer
+
+public:
+    // Constructor with default arguments
+    Customer(int = 0, double = 0.0);
+
+    int getCustNum() const { return custNum; }
+    double getBalanceDue() const { return balanceDue; }
+};
+
+Customer::Customer(int num, double balance) {
+    custNum = num;
+    balanceDue = balance;
+}
+
+// demo-3-1's friend function: a copy per call, and
+// endl flushes the stream after every line
+void displayAsAFriend(Customer cust) {
+    cout << "Customer #" << cust.custNum
+         << " has a balance of $" << cust.balanceDue << endl;
+}
+
+// --------------------------------------------------
+// Number formatting
+// Integers are written two digits at a time from a
+// table of "00".."99"; money is rounded to whole cents
+// once and then printed as two integers.
+// --------------------------------------------------
+const char DIGIT_PAIRS[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+inline char* formatUnsigned(char* dst, uint64_t v) {
+    char tmp[20];
+    char* p = tmp + sizeof(tmp);
+    while (v >= 100) {
+        p -= 2;
+        memcpy(p, DIGIT_PAIRS + (v % 100) * 2, 2);
+        v /= 100;
+    }
+    if (v >= 10) {
+        p -= 2;
+        memcpy(p, DIGIT_PAIRS + v * 2, 2);
+    } else {
+        *--p = char('0' + v);
+    }
+    size_t n = size_t(tmp + sizeof(tmp) - p);
+    memcpy(dst, p, n);
+    return dst + n;
+}
+
+inline char* formatInt(char* dst, int64_t v) {
+    if (v < 0) {
+        *dst++ = '-';
+        return formatUnsigned(dst, 0 - uint64_t(v));
+    }
+    return formatUnsigned(dst, uint64_t(v));
+}
+
+// dollars with exactly two decimals, e.g. -12.05
+inline char* formatCents(char* dst, int64_t cents) {
+    uint64_t c = cents < 0 ? 0 - uint64_t(cents) : uint64_t(cents);
+    if (cents < 0) *dst++ = '-';
+    dst = formatUnsigned(dst, c / 100);
+    *dst++ = '.';
+    memcpy(dst, DIGIT_PAIRS + (c % 100) * 2, 2);
+    return dst + 2;
+}
+
+// --------------------------------------------------
+// Class: CustomerReport
+// Formats "Customer #<n> has a balance of $<x.xx>"
+// lines into a few large buffers that are reused, and
+// hands all full buffers to the kernel in one writev.
+// In async mode a second thread does the writing, so
+// formatting the next buffers overlaps the I/O.
+// --------------------------------------------------
+class CustomerReport {
+public:
+    static constexpr size_t MAX_LINE = 96;   // longest possible line, with room to spare
+
+    CustomerReport(int fd, bool async, size_t bufferBytes = 1 << 20, int buffers = 4);
+    ~CustomerReport();
+    CustomerReport(const CustomerReport&) = delete;
+    CustomerReport& operator=(const CustomerReport&) = delete;
+
+    void add(const Customer& c) {
+        if (end - pos < ptrdiff_t(MAX_LINE)) nextBuffer();
+        pos = formatLine(pos, c);
+    }
+    void flush();
+
+    bool ok() const { return error == 0; }
+    int lastError() const { return error; }
+    uint64_t writeCalls() const { return calls; }
+
+    static char* formatLine(char* dst, const Customer& c) {
+        static const char head[] = "Customer #";
+        static const char middle[] = " has a balance of $";
+        memcpy(dst, head, sizeof(head) - 1);
+        dst = formatInt(dst + sizeof(head) - 1, c.custNum);
+        memcpy(dst, middle, sizeof(middle) - 1);
+        dst = formatCents(dst + sizeof(middle) - 1, llround(c.balanceDue * 100.0));
+        *dst++ = '\n';
+        return dst;
+    }
+
+private:
+    struct Buffer {
+        vector<char> data;
+        size_t used{};
+    };
+    int fd;
+    bool async;
+    vector<Buffer> buffers;
+    int current{};
+    char* pos{nullptr};
+    char* end{nullptr};
+    int error{};
+    uint64_t calls{};
+
+    // async mode: buffers travel formatter -> full -> writer -> spare
+    mutex lock;
+    condition_variable cv;
+    vector<int> full, spare;
+    bool writing{false};
+    bool stopping{false};
+    thread writer;
+
+    void start(int b) {
+        current = b;
+        pos = buffers[b].data.data();
+        end = pos + buffers[b].data.size();
+    }
+    void seal() { buffers[current].used = size_t(pos - buffers[current].data.data()); }
+    void nextBuffer();
+    void writeBuffers(const vector<int>& which);
+    void writerLoop();
+};
+
+CustomerReport::CustomerReport(int fd, bool async, size_t bufferBytes, int count)
+    : fd(fd), async(async), buffers(size_t(count)) {
+    for (Buffer& b : buffers) b.data.resize(max(bufferBytes, MAX_LINE));
+    start(0);
+    if (async) {
+        for (int b = 1; b < count; ++b) spare.push_back(b);
+        writer = thread(&CustomerReport::writerLoop, this);
+    }
+}
+
+CustomerReport::~CustomerReport() {
+    flush();
+    if (async) {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        cv.notify_all();
+        writer.join();
+    }
+}
+
+// One writev for all the given buffers, continuing after partial writes
+void CustomerReport::writeBuffers(const vector<int>& which) {
+    vector<iovec> iov;
+    for (int b : which)
+        if (buffers[b].used) iov.push_back(iovec{ buffers[b].data.data(), buffers[b].used });
+    size_t first = 0;
+    while (first < iov.size() && error == 0) {
+        ssize_t n = writev(fd, iov.data() + first, int(iov.size() - first));
+        ++calls;
+        if (n < 0) {
+            if (errno != EINTR) error = errno;
+            continue;
+        }
+        size_t done = size_t(n);
+        while (first < iov.size() && done >= iov[first].iov_len) done -= iov[first++].iov_len;
+        if (first < iov.size()) {
+            iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + done;
+            iov[first].iov_len -= done;
+        }
+    }
+    for (int b : which) buffers[b].used = 0;
+}
+
+void CustomerReport::nextBuffer() {
+    seal();
+    if (!async) {
+        if (current + 1 < int(buffers.size())) return start(current + 1);
+        vector<int> all;
+        for (int b = 0; b < int(buffers.size()); ++b) all.push_back(b);
+        writeBuffers(all);
+        return start(0);
+    }
+    unique_lock<mutex> guard(lock);
+    full.push_back(current);
+    cv.notify_all();
+    cv.wait(guard, [&] { return !spare.empty(); });
+    int b = spare.back();
+    spare.pop_back();
+    start(b);
+}
+
+void CustomerReport::flush() {
+    seal();
+    if (!async) {
+        vector<int> filled;
+        for (int b = 0; b <= current; ++b) filled.push_back(b);
+        writeBuffers(filled);
+        return start(0);
+    }
+    unique_lock<mutex> guard(lock);
+    if (buffers[current].used) {
+        full.push_back(current);
+        cv.notify_all();
+        cv.wait(guard, [&] { return !spare.empty(); });
+        int b = spare.back();
+        spare.pop_back();
+        start(b);
+    }
+    cv.wait(guard, [&] { return full.empty() && !writing; });
+}
+
+void CustomerReport::writerLoop() {
+    unique_lock<mutex> guard(lock);
+    for (;;) {
+        cv.wait(guard, [&] { return stopping || !full.empty(); });
+        if (full.empty()) return;   // stopping, and nothing left to write
+        vector<int> batch;
+        batch.swap(full);
+        writing = true;
+        guard.unlock();
+        writeBuffers(batch);
+        guard.lock();
+        writing = false;
+        spare.insert(spare.end(), batch.begin(), batch.end());
+        cv.notify_all();
+    }
+}
+
+double seconds(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    Customer c1(101, 250.75);
+    displayAsAFriend(c1);
+    {
+        CustomerReport report(STDOUT_FILENO, false);
+        cout.flush();
+        report.add(c1);
+    }
+
+    const char* path = argc > 1 ? argv[1] : "/dev/null";
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (fd < 0) {
+        perror(path);
+        return 1;
+    }
+
+    // ---- 10^7 customers, balances in whole cents ----
+    const size_t N = 10000000, BASELINE = 1000000;
+    mt19937_64 rng(10);
+    uniform_int_distribution<int64_t> cents(-50000, 5000000);
+    vector<Customer> customers;
+    customers.reserve(N);
+    for (size_t x = 0; x < N; ++x) customers.emplace_back(int(100000 + x), cents(rng) / 100.0);
+
+    // the formatter must agree with printf's %.2f
+    size_t mismatches = 0;
+    for (size_t x = 0; x < 100000; ++x) {
+        char fast[CustomerReport::MAX_LINE], slow[CustomerReport::MAX_LINE];
+        *CustomerReport::formatLine(fast, customers[x]) = '\0';
+        snprintf(slow, sizeof(slow), "Customer #%d has a balance of $%.2f\n",
+                 customers[x].getCustNum(), llround(customers[x].getBalanceDue() * 100.0) / 100.0);
+        mismatches += strcmp(fast, slow) != 0;
+    }
+
+    // demo-3-1's way, on the first 10^6 customers
+    ofstream file(path, ios::app);
+    streambuf* saved = cout.rdbuf(file.rdbuf());
+    auto t = chrono::steady_clock::now();
+    for (size_t x = 0; x < BASELINE; ++x) displayAsAFriend(customers[x]);
+    double baseline = BASELINE / seconds(t);
+    cout.rdbuf(saved);
+
+    cout << endl << fixed << setprecision(1) << "writing to " << path << " with "
+         << thread::hardware_concurrency() << " hardware threads, "
+         << mismatches << " formatting mismatches against printf" << endl;
+    cout << "cout with endl:       " << baseline / 1e6 << " M lines/s" << endl;
+    for (bool async : { false, true }) {
+        // start each run on an empty file, so one run's writeback does not slow the next
+        if (ftruncate(fd, 0) != 0 && errno != EINVAL) perror(path);
+        CustomerReport report(fd, async);
+        t = chrono::steady_clock::now();
+        for (const Customer& c : customers) report.add(c);
+        report.flush();
+        double rate = N / seconds(t);
+        cout << (async ? "CustomerReport async: " : "CustomerReport:       ") << rate / 1e6
+             << " M lines/s (" << rate / baseline << "x, " << report.writeCalls() << " writev calls"
+             << (report.ok() ? "" : ", WRITE FAILED") << ")" << endl;
+    }
+    close(fd);
+    return 0;
+}
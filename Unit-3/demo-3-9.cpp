@@ -0,0 +1,284 @@
+// This code applies large batches of demo-3-2's Transactions to Customers
+// with a partitioned hash join.
+//
+//   ./demo-3-9 [transactions]    benchmark (default 2 * 10^7 transactions)
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+using namespace std;
+
+class Transaction;
+
+// -------------------- CLASS Customer --------------------
+class Customer {
+    // applyTransaction now takes the customer by reference, so the update sticks
+    friend void applyTransaction(Customer&, const Transaction&);
+    friend class TransactionEngine;
+
+private:
+    int custNum;        // Customer number
+    double balanceDue;  // Current balance owed or available
+
+public:
+    // Constructor with default values (custNum=0, balance=0.0)
+    Customer(int = 0, double = 0.0);
+    int getCustNum() const { return custNum; }
+    double getBalanceDue() const { return balanceDue; }
+};
+
+Customer::Customer(int num, double balance) {
+    custNum = num;
+    balanceDue = balance;
+}
+
+// -------------------- CLASS Transaction --------------------
+class Transaction {
+    friend void applyTransaction(Customer&, const Transaction&);
+    friend class TransactionEngine;
+
+private:
+    int transactionNum;  // Transaction identifier
+    int custNum;         // Customer number linked to this transaction
+    double amount;       // Amount of transaction (can be + or -)
+
+public:
+    // Constructor with default values
+    Transaction(int = 0, int = 0, double = 0.0);
+    int getTransactionNum() const { return transactionNum; }
+    int getCustNum() const { return custNum; }
+    double getAmount() const { return amount; }
+};
+
+Transaction::Transaction(int trans, int cust, double amt) {
+    transactionNum = trans;
+    custNum = cust;
+    amount = amt;
+}
+
+// -------------------- FRIEND FUNCTION --------------------
+void applyTransaction(Customer& cust, const Transaction& trans) {
+    cust.balanceDue += trans.amount;
+}
+
+// -------------------- CLASS TransactionEngine --------------------
+// Applies a whole batch of transactions at once:
+//  1. both transactions and customers are radix-partitioned by a hash of
+//     custNum, so a customer and all of its transactions land in the same
+//     partition, small enough for the cache
+//  2. each partition builds a hash table of its customers and probes it
+//     with its transactions; one thread owns a partition, so no locks
+//  3. updated balances are written back, and transactions whose customer
+//     does not exist are returned as exceptions, in input order
+// Partitioning is stable, so every customer sees its transactions in input
+// order and the balances are bit-for-bit those of applying them one by one.
+// Customer numbers in the table should be unique: if several rows share
+// a custNum, every transaction for it goes to the first of those rows and
+// the others keep their balances.
+class TransactionEngine {
+public:
+    struct Result {
+        size_t applied{};
+        vector<Transaction> exceptions;   // no customer with that custNum
+    };
+
+    // partitionBits = 0 picks about 2048 customers per partition; otherwise
+    // there are 2^partitionBits partitions, for partitionBits 1 .. 16
+    explicit TransactionEngine(unsigned threads, int partitionBits = 0)
+        : threads(max(1u, threads)), bits(partitionBits) {
+        if (partitionBits < 0 || partitionBits > 16)
+            throw invalid_argument("partitionBits " + to_string(partitionBits) + " is outside 0 .. 16");
+    }
+
+    Result apply(vector<Customer>& customers, const vector<Transaction>& transactions);
+
+private:
+    struct Row {            // one partitioned transaction or customer
+        int32_t custNum;
+        uint32_t index;     // position in the caller's vector
+        double value;       // amount, or balance
+    };
+    struct Slot {
+        int32_t custNum;
+        uint32_t row;       // customer row + 1; 0 = empty
+    };
+    unsigned threads;
+    int bits;
+
+    static uint32_t hash(int32_t custNum) { return uint32_t(custNum) * 0x9E3779B1u; }
+
+    template <typename F>
+    void onEveryThread(F f) {
+        vector<thread> pool;
+        for (unsigned w = 1; w < threads; ++w) pool.emplace_back(f, w);
+        f(0u);
+        for (thread& t : pool) t.join();
+    }
+
+    // Stable parallel scatter of src into partitions; bounds[p] .. bounds[p+1]
+    template <typename Src>
+    void partition(const vector<Src>& src, vector<Row>& out, vector<size_t>& bounds, int b) {
+        const size_t n = src.size(), parts = size_t(1) << b;
+        const int shift = 32 - b;
+        vector<size_t> offset(threads * parts, 0);
+        onEveryThread([&](unsigned w) {
+            size_t* count = &offset[w * parts];
+            for (size_t x = n * w / threads; x < n * (w + 1) / threads; ++x)
+                ++count[hash(src[x].custNum) >> shift];
+        });
+        // thread-major within each partition keeps the input order
+        bounds.assign(parts + 1, 0);
+        size_t running = 0;
+        for (size_t p = 0; p < parts; ++p) {
+            bounds[p] = running;
+            for (unsigned w = 0; w < threads; ++w) {
+                size_t c = offset[w * parts + p];
+                offset[w * parts + p] = running;
+                running += c;
+            }
+        }
+        bounds[parts] = running;
+        out.resize(n);
+        onEveryThread([&](unsigned w) {
+            size_t* next = &offset[w * parts];
+            for (size_t x = n * w / threads; x < n * (w + 1) / threads; ++x)
+                out[next[hash(src[x].custNum) >> shift]++] = Row{ src[x].custNum, uint32_t(x), valueOf(src[x]) };
+        });
+    }
+    static double valueOf(const Customer& c) { return c.balanceDue; }
+    static double valueOf(const Transaction& t) { return t.amount; }
+};
+
+TransactionEngine::Result TransactionEngine::apply(vector<Customer>& customers,
+                                                   const vector<Transaction>& transactions) {
+    int b = bits;
+    if (b == 0) {
+        b = 4;
+        while (b < 16 && (customers.size() >> b) > 2048) ++b;
+    }
+    const size_t parts = size_t(1) << b;
+
+    vector<Row> custRows, transRows;
+    vector<size_t> custBounds, transBounds;
+    partition(customers, custRows, custBounds, b);
+    partition(transactions, transRows, transBounds, b);
+
+    vector<vector<uint32_t>> misses(parts);
+    atomic<size_t> nextPart{0}, applied{0};
+    onEveryThread([&](unsigned) {
+        vector<Slot> table;
+        size_t done = 0;
+        for (size_t p; (p = nextPart++) < parts; ) {
+            // build: this partition's customers
+            size_t cFirst = custBounds[p], cCount = custBounds[p + 1] - cFirst;
+            size_t size = 16;
+            while (size < 2 * cCount) size *= 2;
+            const size_t mask = size - 1;
+            table.assign(size, Slot{ 0, 0 });
+            for (size_t r = 0; r < cCount; ++r) {
+                int32_t key = custRows[cFirst + r].custNum;
+                size_t s = (hash(key) ^ (hash(key) >> 15)) & mask;
+                while (table[s].row) s = (s + 1) & mask;
+                table[s] = Slot{ key, uint32_t(r + 1) };
+            }
+            // probe: apply this partition's transactions in order
+            for (size_t t = transBounds[p]; t < transBounds[p + 1]; ++t) {
+                int32_t key = transRows[t].custNum;
+                size_t s = (hash(key) ^ (hash(key) >> 15)) & mask;
+                while (table[s].row && table[s].custNum != key) s = (s + 1) & mask;
+                if (table[s].row) {
+                    custRows[cFirst + table[s].row - 1].value += transRows[t].value;
+                    ++done;
+                } else {
+                    misses[p].push_back(transRows[t].index);
+                }
+            }
+            // each customer is in exactly one partition: plain writes, no races
+            for (size_t r = cFirst; r < cFirst + cCount; ++r)
+                customers[custRows[r].index].balanceDue = custRows[r].value;
+        }
+        applied += done;
+    });
+
+    Result result;
+    result.applied = applied;
+    vector<uint32_t> missed;
+    for (const vector<uint32_t>& m : misses) missed.insert(missed.end(), m.begin(), m.end());
+    sort(missed.begin(), missed.end());
+    result.exceptions.reserve(missed.size());
+    for (uint32_t x : missed) result.exceptions.push_back(transactions[x]);
+    return result;
+}
+
+double seconds(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// -------------------- MAIN PROGRAM --------------------
+int main(int argc, char* argv[]) {
+    // Create a transaction: ID=111, customer=888, amount=-150.00
+    Transaction oneTrans(111, 888, -150.00);
+    Customer oneCust(888, 200.00);
+    applyTransaction(oneCust, oneTrans);
+    cout << "After transaction #" << oneTrans.getTransactionNum() << " customer #"
+         << oneCust.getCustNum() << " has a balance of $" << oneCust.getBalanceDue() << endl;
+
+    // ---- 10^6 customers, 1% of transactions for unknown customers ----
+    const size_t CUSTOMERS = 1000000;
+    const size_t N = argc > 1 ? strtoull(argv[1], nullptr, 10) : 20000000;
+    mt19937_64 rng(11);
+    vector<Customer> start;
+    start.reserve(CUSTOMERS);
+    for (size_t c = 0; c < CUSTOMERS; ++c)
+        start.emplace_back(int(1000000 + 7 * c), double(rng() % 100000) / 100.0);
+    vector<Transaction> batch;
+    batch.reserve(N);
+    for (size_t t = 0; t < N; ++t) {
+        uint64_t r = rng();
+        int cust = r % 100 == 0 ? int(r >> 40) % 1000000 : start[(r >> 8) % CUSTOMERS].getCustNum();
+        batch.emplace_back(int(t), cust, double(int64_t(r >> 44) - 500000) / 100.0);
+    }
+
+    // one at a time through a hash map, for the reference balances
+    vector<Customer> expected = start;
+    auto t = chrono::steady_clock::now();
+    unordered_map<int, size_t> where;
+    where.reserve(CUSTOMERS);
+    for (size_t c = 0; c < expected.size(); ++c) where.emplace(expected[c].getCustNum(), c);
+    size_t unmatched = 0;
+    for (const Transaction& tr : batch) {
+        auto it = where.find(tr.getCustNum());
+        if (it == where.end()) ++unmatched;
+        else applyTransaction(expected[it->second], tr);
+    }
+    double oneSec = seconds(t);
+
+    cout << endl << fixed << setprecision(1) << N << " transactions, " << thread::hardware_concurrency()
+         << " hardware threads" << endl;
+    cout << "one at a time:   " << N / oneSec / 1e6 << " M transactions/s, " << unmatched
+         << " exceptions" << endl;
+    for (unsigned threads = 1; threads <= 8; threads *= 2) {
+        vector<Customer> customers = start;
+        TransactionEngine engine(threads);
+        t = chrono::steady_clock::now();
+        TransactionEngine::Result r = engine.apply(customers, batch);
+        double sec = seconds(t);
+        bool same = r.exceptions.size() == unmatched;
+        for (size_t c = 0; c < CUSTOMERS && same; ++c)
+            same = customers[c].getBalanceDue() == expected[c].getBalanceDue();
+        cout << setw(2) << threads << " thread" << (threads == 1 ? ": " : "s:") << "      "
+             << N / sec / 1e6 << " M transactions/s, " << r.exceptions.size() << " exceptions, balances "
+             << (same ? "identical" : "DIFFERENT") << endl;
+    }
+    return 0;
+}
@@ -10,13 +10,19 @@ protected:
     string firstName;
 
 public:
-    // Sets the person's fields
+    // Sets the person's fields (assigning into the existing strings reuses
+    // their storage, so resetting a Person from lvalues need not allocate)
     void setFields(int i, const string &last, const string &first) {
         id = i;
         lastName = last;
         firstName = first;
     }
 
+    // Read-only access without copying the strings
+    int getId() const { return id; }
+    const string &getLastName() const { return lastName; }
+    const string &getFirstName() const { return firstName; }
+
     // Outputs person's data
     void outputData() const {
         cout << "ID: " << id << endl;
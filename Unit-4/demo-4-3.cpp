@@ -1,5 +1,6 @@
 #include <iostream>
 #include <string>
+#include <utility>
 using namespace std;
 
 // ===================
@@ -14,7 +15,9 @@ public:
     // Function prototypes
     void setFields(int, string, string);
     void outputData();
-    int getId();
+    int getId() const;
+    const string& getLastName() const;
+    const string& getFirstName() const;
 };
 
 // --------------------
@@ -22,8 +25,8 @@ public:
 // --------------------
 void Person::setFields(int num, string last, string first) {
     idNum = num;
-    lastName = last;
-    firstName = first;
+    lastName = std::move(last);
+    firstName = std::move(first);
 }
 
 void Person::outputData() {
@@ -31,10 +34,18 @@ void Person::outputData() {
          << firstName << " " << lastName << endl;
 }
 
-int Person::getId() {
+int Person::getId() const {
     return idNum;
 }
 
+const string& Person::getLastName() const {
+    return lastName;
+}
+
+const string& Person::getFirstName() const {
+    return firstName;
+}
+
 // ==========================
 // Derived Class: Employee
 // ==========================
@@ -53,7 +64,7 @@ public:
 void Employee::setFields(int num, string last, string first,
                          int dep, double sal) {
     // Call base class version to set id + names
-    Person::setFields(num, last, first);
+    Person::setFields(num, std::move(last), std::move(first));
     // Set own new fields
     dept = dep;
     hourlyRate = sal;